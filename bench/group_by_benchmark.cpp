@@ -0,0 +1,97 @@
+// Compares parallel group-by strategies on orderkey-like keys (as in Q3/Q18's GROUP BY
+// l_orderkey): per-task std::unordered_map partials merged serially, and HashGroupBy.
+//
+// Usage: group_by_benchmark [rows] [groups] [threads]
+// Group keys follow dbgen's sparse o_orderkey pattern; rows pick a group at random.
+
+#include "hash_group_by.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+template <typename Fn>
+double timeMs(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char *name, double ms, size_t rows, size_t groups, uint64_t checksum) {
+    std::cout << name << ": " << ms << " ms, " << (static_cast<double>(rows) / ms / 1000.0)
+              << " M rows/s, " << groups << " groups (checksum " << checksum << ")\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 6000000;
+    size_t groups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1500000;
+    size_t threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, groups - 1);
+    std::vector<int> keys(rows);
+    std::vector<int64_t> values(rows);
+    for (size_t i = 0; i < rows; i++) {
+        size_t g = pick(rng);
+        keys[i] = static_cast<int>((g / 8) * 32 + g % 8 + 1);
+        values[i] = static_cast<int64_t>(i % 1000);
+    }
+    auto range = [&](size_t t) { return std::make_pair(rows * t / threads, rows * (t + 1) / threads); };
+
+    std::cout << "rows: " << rows << ", groups: " << groups << ", threads: " << threads << "\n";
+    ThreadPool pool(threads);
+
+    {
+        std::unordered_map<int, int64_t> result;
+        double ms = timeMs([&]() {
+            std::vector<std::future<std::unordered_map<int, int64_t>>> futures;
+            for (size_t t = 0; t < threads; t++) {
+                futures.push_back(pool.enqueue([&, t]() {
+                    std::unordered_map<int, int64_t> partial;
+                    for (size_t i = range(t).first; i < range(t).second; i++)
+                        partial[keys[i]] += values[i];
+                    return partial;
+                }));
+            }
+            for (auto &future : futures) {
+                for (const auto &p : future.get())
+                    result[p.first] += p.second;
+            }
+        });
+        uint64_t checksum = 0;
+        for (const auto &p : result)
+            checksum += static_cast<uint64_t>(p.first) * static_cast<uint64_t>(p.second);
+        report("unordered_map partials + serial merge", ms, rows, result.size(), checksum);
+    }
+
+    {
+        std::vector<HashGroupBy<int64_t>::Group> result;
+        double ms = timeMs([&]() {
+            HashGroupBy<int64_t> groupBy(pool, threads);
+            std::vector<std::future<void>> futures;
+            for (size_t t = 0; t < threads; t++) {
+                futures.push_back(pool.enqueue([&, t]() {
+                    auto &local = groupBy.local(t);
+                    for (size_t i = range(t).first; i < range(t).second; i++)
+                        local.add(keys[i], values[i]);
+                }));
+            }
+            for (auto &future : futures)
+                future.get();
+            result = groupBy.merge();
+        });
+        uint64_t checksum = 0;
+        for (const auto &group : result)
+            checksum += static_cast<uint64_t>(group.key) * static_cast<uint64_t>(group.sum);
+        report("HashGroupBy", ms, rows, result.size(), checksum);
+    }
+    return 0;
+}
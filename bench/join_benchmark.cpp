@@ -0,0 +1,162 @@
+// Compares the lineitem-orders join strategies on synthetic keys:
+// the original std::unordered_map build + probe, JoinIndex, and the parallel RadixJoin.
+// It also times the JoinIndex probe alone with and without group prefetching, in CPU cycles
+// per probe tuple (rdtsc on x86).
+//
+// Usage: join_benchmark [build_rows] [probe_rows] [threads]
+// Build keys follow dbgen's sparse o_orderkey pattern (8 used keys out of every 32); probe
+// keys are drawn from the build keys in random order, like l_orderkey after a shuffle.
+
+#include "join_index.hpp"
+#include "radix_join.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+// Cycle counter for per-tuple costs; falls back to nanoseconds off x86.
+uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Probes index with keys in batches the size of the Q5 scan's, optionally prefetching the
+// next group of slots before resolving the current one (as Q5Pipeline does). Returns cycles per probe tuple.
+double probeCycles(const JoinIndex &index, const std::vector<int> &keys, bool prefetch, uint64_t &checksum) {
+    constexpr size_t BatchRows = 1024;
+    constexpr size_t Group = 16;
+    uint64_t start = cycles();
+    for (size_t base = 0; base < keys.size(); base += BatchRows) {
+        size_t end = std::min(keys.size(), base + BatchRows);
+        if (prefetch) {
+            for (size_t i = base; i < std::min(end, base + Group); i++)
+                index.prefetch(keys[i]);
+        }
+        for (size_t group = base; group < end; group += Group) {
+            size_t groupEnd = std::min(end, group + Group);
+            if (prefetch) {
+                for (size_t i = groupEnd; i < std::min(end, groupEnd + Group); i++)
+                    index.prefetch(keys[i]);
+            }
+            for (size_t i = group; i < groupEnd; i++) {
+                uint32_t row = index.find(keys[i]);
+                if (row != JoinIndex::NotFound)
+                    checksum += row;
+            }
+        }
+    }
+    return static_cast<double>(cycles() - start) / static_cast<double>(keys.size());
+}
+
+template <typename Fn>
+double timeMs(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char *name, double ms, size_t probeRows, uint64_t checksum) {
+    std::cout << name << ": " << ms << " ms, " << (static_cast<double>(probeRows) / ms / 1000.0)
+              << " M probe rows/s (checksum " << checksum << ")\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t buildRows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1500000;
+    size_t probeRows = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4 * buildRows;
+    size_t threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+
+    std::vector<int> buildKeys(buildRows);
+    for (size_t i = 0; i < buildRows; i++)
+        buildKeys[i] = static_cast<int>((i / 8) * 32 + i % 8 + 1);
+    std::mt19937 rng(42);
+    std::vector<int> probeKeys(probeRows);
+    std::uniform_int_distribution<size_t> pick(0, buildRows - 1);
+    for (auto &key : probeKeys)
+        key = buildKeys[pick(rng)];
+
+    std::cout << "build rows: " << buildRows << ", probe rows: " << probeRows << ", threads: " << threads << "\n";
+
+    {
+        uint64_t checksum = 0;
+        double ms = timeMs([&]() {
+            std::unordered_map<int, uint32_t> map;
+            for (size_t i = 0; i < buildRows; i++)
+                map[buildKeys[i]] = static_cast<uint32_t>(i);
+            for (size_t i = 0; i < probeRows; i++) {
+                auto it = map.find(probeKeys[i]);
+                if (it != map.end())
+                    checksum += it->second;
+            }
+        });
+        report("unordered_map (1 thread)", ms, probeRows, checksum);
+    }
+
+    {
+        uint64_t checksum = 0;
+        double ms = timeMs([&]() {
+            JoinIndex index;
+            index.build(buildRows, [&](size_t i) { return buildKeys[i]; });
+            for (size_t i = 0; i < probeRows; i++) {
+                uint32_t row = index.find(probeKeys[i]);
+                if (row != JoinIndex::NotFound)
+                    checksum += row;
+            }
+        });
+        report("JoinIndex (1 thread)", ms, probeRows, checksum);
+    }
+
+    {
+        JoinIndex index;
+        index.build(buildRows, [&](size_t i) { return buildKeys[i]; });
+        uint64_t plainChecksum = 0;
+        uint64_t prefetchChecksum = 0;
+        // Best of three alternating runs; single runs are noisy on shared hosts.
+        double plain = 0;
+        double prefetched = 0;
+        for (int run = 0; run < 3; run++) {
+            plainChecksum = 0;
+            prefetchChecksum = 0;
+            double p = probeCycles(index, probeKeys, false, plainChecksum);
+            double q = probeCycles(index, probeKeys, true, prefetchChecksum);
+            plain = run == 0 ? p : std::min(plain, p);
+            prefetched = run == 0 ? q : std::min(prefetched, q);
+        }
+        std::cout << "JoinIndex probe: " << plain << " cycles/tuple (checksum " << plainChecksum << ")\n";
+        std::cout << "JoinIndex probe, group prefetch: " << prefetched << " cycles/tuple (checksum "
+                  << prefetchChecksum << ")\n";
+    }
+
+    {
+        ThreadPool pool(threads);
+        std::vector<uint64_t> checksums(threads, 0);
+        unsigned bits = 0;
+        double ms = timeMs([&]() {
+            RadixJoin join(pool);
+            join.build(buildKeys.data(), buildRows);
+            bits = join.radixBits();
+            join.probe(probeKeys.data(), probeRows, threads, [&](size_t task, uint32_t, uint32_t row) {
+                checksums[task] += row;
+            });
+        });
+        uint64_t checksum = 0;
+        for (uint64_t c : checksums)
+            checksum += c;
+        std::cout << "RadixJoin uses " << bits << " radix bits\n";
+        report("RadixJoin", ms, probeRows, checksum);
+    }
+    return 0;
+}
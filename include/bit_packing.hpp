@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vertical bit packing of unsigned 32-bit values in blocks of PackBlockValues (256).
+// A block packed at width b holds b * 8 words: word w of lane l is at index w * 8 + l, and lane
+// l stores values l, l + 8, l + 16, ... back to back in its own little-endian bit stream. All
+// eight lanes therefore sit at the same bit offset, so one 256-bit load, shift and mask unpacks
+// eight consecutive values (the SIMD-BP128 layout of Lemire and Boytsov, widened to AVX2).
+// Width 0 packs nothing: every value is 0.
+
+constexpr size_t PackBlockValues = 256;
+constexpr size_t PackLanes = 8;
+
+// Words needed for one block at width bits.
+inline size_t packedBlockWords(unsigned bits) {
+    return static_cast<size_t>(bits) * PackLanes;
+}
+
+// Words holding `values` values at width bits; the last block is padded to full size.
+inline size_t packedWordCount(size_t values, unsigned bits) {
+    return (values + PackBlockValues - 1) / PackBlockValues * packedBlockWords(bits);
+}
+
+// Smallest width that holds every value up to maxValue.
+inline unsigned bitWidth(uint64_t maxValue) {
+    unsigned bits = 0;
+    while (bits < 64 && (maxValue >> bits) != 0)
+        bits++;
+    return bits;
+}
+
+// Packs in[0..PackBlockValues) at width bits (each value < 2^bits) into out[0..packedBlockWords).
+void packBlock(const uint32_t *in, unsigned bits, uint32_t *out);
+
+// Unpacks `blocks` consecutive blocks into out[0..blocks * PackBlockValues).
+using UnpackKernel = void (*)(const uint32_t *packed, unsigned bits, size_t blocks, uint32_t *out);
+
+// The widest kernel supported by the running CPU (AVX2 or scalar), selected once.
+UnpackKernel unpackKernel();
+const char *unpackKernelName();
+
+// The individual kernels, for checking them against each other: the portable one, and the
+// AVX2 one or nullptr if the build or the running CPU has no AVX2.
+UnpackKernel scalarUnpackKernel();
+UnpackKernel avx2UnpackKernel();
+
+// Value i of a packed stream (blocks laid out back to back).
+inline uint32_t unpackValue(const uint32_t *packed, unsigned bits, size_t i) {
+    if (bits == 0)
+        return 0;
+    const uint32_t *block = packed + (i / PackBlockValues) * packedBlockWords(bits);
+    size_t r = i % PackBlockValues;
+    size_t lane = r % PackLanes;
+    size_t bit = (r / PackLanes) * bits;
+    size_t word = bit / 32;
+    unsigned offset = static_cast<unsigned>(bit % 32);
+    uint64_t value = block[word * PackLanes + lane] >> offset;
+    if (offset + bits > 32)
+        value |= static_cast<uint64_t>(block[(word + 1) * PackLanes + lane]) << (32 - offset);
+    return static_cast<uint32_t>(value & ((uint64_t(1) << bits) - 1));
+}
@@ -0,0 +1,651 @@
+#pragma once
+
+#include "bit_packing.hpp"
+#include "tpch_records.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Columnar (struct-of-arrays) storage for the tables the query scans.
+// Every column a table holds has rowCount values; columns left out of the load stay empty. A
+// column is an owned array after a text load, may then be encoded into a compact bit-packed
+// form (see ColumnEncoding), and is a view into the mapping after a snapshot load. push_back
+// and operator[] accept and return the row structs from tpch_records.hpp, so code written
+// against the old std::vector<Row> storage keeps working.
+
+// How a column stores its values. Plain holds an array of T. The other encodings hold one
+// unsigned code per row, bit-packed at a fixed width in PackBlockValues blocks (bit_packing.hpp):
+//   FrameOfReference  value = reference + code, for columns whose range fits 32 bits
+//   Dictionary        value = dictionary[code], for columns with few distinct values
+enum class ColumnEncoding : uint8_t {
+    Plain,
+    FrameOfReference,
+    Dictionary
+};
+
+inline const char *columnEncodingName(ColumnEncoding encoding) {
+    switch (encoding) {
+    case ColumnEncoding::FrameOfReference:
+        return "for";
+    case ColumnEncoding::Dictionary:
+        return "dict";
+    default:
+        return "plain";
+    }
+}
+
+// Maps a column value to and from int64 for encoding. Columns of other types stay plain.
+template <typename T, typename = void>
+struct ColumnCodec {
+    static constexpr bool Encodable = false;
+};
+
+template <typename T>
+struct ColumnCodec<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, char>::value &&
+                                       !std::is_same<T, bool>::value && sizeof(T) <= 4>> {
+    static constexpr bool Encodable = true;
+    static int64_t toInt(T value) { return value; }
+    static T fromInt(int64_t value) { return static_cast<T>(value); }
+};
+
+template <unsigned Scale>
+struct ColumnCodec<Decimal<Scale>> {
+    static constexpr bool Encodable = true;
+    static int64_t toInt(Decimal<Scale> value) { return value.units; }
+    static Decimal<Scale> fromInt(int64_t value) { return Decimal<Scale>{value}; }
+};
+
+// One column of fixed-size values. A column either owns its values (filled by the loaders)
+// or is a read-only view into memory kept alive by owner: a mapped snapshot file, or the
+// packed codes built by encode(). Appending to a view first decodes it into owned storage.
+template <typename T>
+class Column {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "columns hold plain values");
+
+    // Most distinct values a Dictionary column may have.
+    static constexpr size_t DictionaryMaxValues = 4096;
+    // Blocks unpacked per step of read().
+    static constexpr size_t ReadBlocks = 4;
+
+    Column() = default;
+
+    // A view of values[0..count) that keeps owner alive as long as the column exists.
+    static Column view(const T *values, size_t count, std::shared_ptr<const void> owner) {
+        Column column;
+        column.viewing = true;
+        column.viewData = values;
+        column.viewSize = count;
+        column.owner = std::move(owner);
+        return column;
+    }
+
+    // An encoded view of count rows: packed holds packedWordCount(count, bits) words of codes
+    // and dictionary the dictionarySize values of a Dictionary column (nullptr otherwise).
+    static Column encodedView(ColumnEncoding encoding, unsigned bits, int64_t reference, size_t count,
+                              const uint32_t *packed, const T *dictionary, size_t dictionarySize,
+                              std::shared_ptr<const void> owner) {
+        Column column = view(nullptr, count, std::move(owner));
+        column.scheme = encoding;
+        column.bits = bits;
+        column.base = reference;
+        column.packed = packed;
+        column.dict = dictionary;
+        column.dictSize = dictionarySize;
+        return column;
+    }
+
+    bool isView() const { return viewing; }
+    ColumnEncoding encoding() const { return scheme; }
+    bool isEncoded() const { return scheme != ColumnEncoding::Plain; }
+    unsigned packedBits() const { return bits; }
+    int64_t reference() const { return base; }
+    const uint32_t *packedWords() const { return packed; }
+    const T *dictionary() const { return dict; }
+    size_t dictionarySize() const { return dictSize; }
+
+    // The value array of a plain column; nullptr for an encoded one (use read()).
+    const T *data() const { return isEncoded() ? nullptr : isView() ? viewData : values.data(); }
+    size_t size() const { return isView() ? viewSize : values.size(); }
+    bool empty() const { return size() == 0; }
+    const T *begin() const { return data(); }
+    const T *end() const { return data() + size(); }
+
+    // Bytes of column data, packed codes and dictionary included.
+    size_t sizeBytes() const {
+        if (!isEncoded())
+            return size() * sizeof(T);
+        return packedWordCount(size(), bits) * sizeof(uint32_t) + dictSize * sizeof(T);
+    }
+
+    T operator[](size_t i) const {
+        if constexpr (ColumnCodec<T>::Encodable) {
+            if (scheme == ColumnEncoding::FrameOfReference)
+                return ColumnCodec<T>::fromInt(base + unpackValue(packed, bits, i));
+            if (scheme == ColumnEncoding::Dictionary)
+                return dict[unpackValue(packed, bits, i)];
+        }
+        return data()[i];
+    }
+
+    // Rows [first, first + count): a pointer into a plain column, or scratch (room for count
+    // values) holding the rows decoded a few blocks at a time with the SIMD unpack kernel.
+    const T *read(size_t first, size_t count, T *scratch) const {
+        if (!isEncoded())
+            return data() + first;
+        if constexpr (ColumnCodec<T>::Encodable) {
+            uint32_t codes[ReadBlocks * PackBlockValues];
+            UnpackKernel unpack = unpackKernel();
+            size_t done = 0;
+            while (done < count) {
+                size_t row = first + done;
+                size_t skip = row % PackBlockValues;
+                size_t blocks = std::min(ReadBlocks, (skip + count - done + PackBlockValues - 1) / PackBlockValues);
+                unpack(packed + row / PackBlockValues * packedBlockWords(bits), bits, blocks, codes);
+                size_t n = std::min(blocks * PackBlockValues - skip, count - done);
+                decode(codes + skip, n, scratch + done);
+                done += n;
+            }
+        }
+        return scratch;
+    }
+
+    // Smallest and largest value of rows [first, first + count), count > 0. Both encodings keep
+    // the order of values (a constant is added, the dictionary is sorted), so an encoded column
+    // compares its unpacked codes and decodes only the two extremes.
+    std::pair<T, T> range(size_t first, size_t count) const {
+        if constexpr (ColumnCodec<T>::Encodable) {
+            if (isEncoded()) {
+                uint32_t codes[ReadBlocks * PackBlockValues];
+                UnpackKernel unpack = unpackKernel();
+                uint32_t lo = UINT32_MAX, hi = 0;
+                size_t done = 0;
+                while (done < count) {
+                    size_t row = first + done;
+                    size_t skip = row % PackBlockValues;
+                    size_t blocks = std::min(ReadBlocks, (skip + count - done + PackBlockValues - 1) / PackBlockValues);
+                    unpack(packed + row / PackBlockValues * packedBlockWords(bits), bits, blocks, codes);
+                    size_t n = std::min(blocks * PackBlockValues - skip, count - done);
+                    for (size_t i = skip; i < skip + n; i++) {
+                        lo = std::min(lo, codes[i]);
+                        hi = std::max(hi, codes[i]);
+                    }
+                    done += n;
+                }
+                T extremes[2];
+                uint32_t extremeCodes[2] = {lo, hi};
+                decode(extremeCodes, 2, extremes);
+                return {extremes[0], extremes[1]};
+            }
+        }
+        const T *values = data() + first;
+        T lo = values[0], hi = values[0];
+        for (size_t i = 1; i < count; i++) {
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+        }
+        return {lo, hi};
+    }
+
+    // Replaces an owned plain column by the smallest of FrameOfReference and Dictionary, if
+    // either is smaller than the array (FrameOfReference on a tie, as it decodes without a
+    // lookup). Views and columns of non-integer types are left as they are.
+    void encode() {
+        if constexpr (ColumnCodec<T>::Encodable) {
+            using Codec = ColumnCodec<T>;
+            if (isView() || values.empty())
+                return;
+            size_t rows = values.size();
+            int64_t lo = Codec::toInt(values[0]), hi = lo;
+            for (const T &value : values) {
+                lo = std::min(lo, Codec::toInt(value));
+                hi = std::max(hi, Codec::toInt(value));
+            }
+            uint64_t range = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+            unsigned forBits = bitWidth(range);
+            // Sorted distinct values, or none once there are too many for a dictionary to beat
+            // frame of reference (it needs fewer than 2^(forBits - 1) values to save a bit).
+            size_t dictionaryLimit = forBits > 12 ? DictionaryMaxValues : forBits == 0 ? 0 : size_t(1) << (forBits - 1);
+            std::vector<int64_t> distinct;
+            int64_t last = lo;
+            bool haveLast = false;
+            for (size_t i = 0; i < rows && dictionaryLimit > 0; i++) {
+                int64_t v = Codec::toInt(values[i]);
+                if (haveLast && v == last)
+                    continue;
+                auto it = std::lower_bound(distinct.begin(), distinct.end(), v);
+                if (it == distinct.end() || *it != v) {
+                    if (distinct.size() == dictionaryLimit) {
+                        distinct.clear();
+                        break;
+                    }
+                    distinct.insert(it, v);
+                }
+                last = v;
+                haveLast = true;
+            }
+
+            const size_t unusable = SIZE_MAX;
+            size_t forBytes = forBits <= 32 ? packedWordCount(rows, forBits) * sizeof(uint32_t) : unusable;
+            unsigned dictBits = distinct.empty() ? 0 : bitWidth(distinct.size() - 1);
+            size_t dictBytes = distinct.empty() ? unusable
+                                                : packedWordCount(rows, dictBits) * sizeof(uint32_t) + distinct.size() * sizeof(T);
+            if (std::min(forBytes, dictBytes) >= rows * sizeof(T))
+                return;
+
+            auto storage = std::make_shared<EncodedStorage>();
+            ColumnEncoding chosen = forBytes <= dictBytes ? ColumnEncoding::FrameOfReference : ColumnEncoding::Dictionary;
+            unsigned width = chosen == ColumnEncoding::FrameOfReference ? forBits : dictBits;
+            if (chosen == ColumnEncoding::Dictionary) {
+                for (int64_t v : distinct)
+                    storage->dictionary.push_back(Codec::fromInt(v));
+            }
+            storage->packed.resize(packedWordCount(rows, width));
+            uint32_t block[PackBlockValues];
+            for (size_t start = 0; start < rows; start += PackBlockValues) {
+                for (size_t k = 0; k < PackBlockValues; k++) {
+                    size_t row = start + k;
+                    if (row >= rows) {
+                        block[k] = 0;
+                    } else if (chosen == ColumnEncoding::FrameOfReference) {
+                        block[k] = static_cast<uint32_t>(Codec::toInt(values[row]) - lo);
+                    } else {
+                        block[k] = static_cast<uint32_t>(
+                            std::lower_bound(distinct.begin(), distinct.end(), Codec::toInt(values[row])) - distinct.begin());
+                    }
+                }
+                packBlock(block, width, storage->packed.data() + start / PackBlockValues * packedBlockWords(width));
+            }
+
+            const uint32_t *codes = storage->packed.data();
+            const T *dictionary = storage->dictionary.empty() ? nullptr : storage->dictionary.data();
+            size_t dictionarySize = storage->dictionary.size();
+            *this = encodedView(chosen, width, chosen == ColumnEncoding::FrameOfReference ? lo : 0, rows, codes,
+                                dictionary, dictionarySize, std::move(storage));
+        }
+    }
+
+    void reserve(size_t n) {
+        materialize();
+        values.reserve(n);
+    }
+
+    void push_back(const T &value) {
+        materialize();
+        values.push_back(value);
+    }
+
+    void append(const Column &other) {
+        materialize();
+        if (other.isEncoded()) {
+            size_t old = values.size();
+            values.resize(old + other.size());
+            other.read(0, other.size(), values.data() + old);
+        } else {
+            values.insert(values.end(), other.begin(), other.end());
+        }
+    }
+
+    // Drops every row. An owned column keeps its capacity, so it can be refilled without
+    // reallocating; a view becomes an empty owned column.
+    void clear() {
+        if (isView())
+            *this = Column();
+        else
+            values.clear();
+    }
+
+private:
+    // Packed codes and dictionary built by encode(), shared by copies of the column.
+    struct EncodedStorage {
+        std::vector<uint32_t> packed;
+        std::vector<T> dictionary;
+    };
+
+    void decode(const uint32_t *codes, size_t n, T *out) const {
+        if constexpr (ColumnCodec<T>::Encodable) {
+            if (scheme == ColumnEncoding::FrameOfReference) {
+                for (size_t i = 0; i < n; i++)
+                    out[i] = ColumnCodec<T>::fromInt(base + codes[i]);
+            } else {
+                for (size_t i = 0; i < n; i++)
+                    out[i] = dict[codes[i]];
+            }
+        }
+    }
+
+    void materialize() {
+        if (!isView())
+            return;
+        std::vector<T> owned(viewSize);
+        if (isEncoded())
+            read(0, viewSize, owned.data());
+        else
+            owned.assign(viewData, viewData + viewSize);
+        *this = Column();
+        values = std::move(owned);
+    }
+
+    std::vector<T> values;
+    bool viewing = false;
+    const T *viewData = nullptr;
+    size_t viewSize = 0;
+    ColumnEncoding scheme = ColumnEncoding::Plain;
+    unsigned bits = 0;
+    int64_t base = 0;
+    const uint32_t *packed = nullptr;
+    const T *dict = nullptr;
+    size_t dictSize = 0;
+    std::shared_ptr<const void> owner;
+};
+
+template <typename T>
+void appendColumn(Column<T> &dst, const Column<T> &src) {
+    dst.append(src);
+}
+
+// Set of a table's columns: bit i stands for the column at zero-based position i of its .tbl
+// file. The loaders parse only the columns in a table's set (see ColumnSelection).
+using ColumnSet = uint32_t;
+
+constexpr ColumnSet columnBit(int position) {
+    return ColumnSet(1) << position;
+}
+
+// Each table lists the .tbl positions it can hold, the Default set (the columns Q5 reads) and
+// the columns it actually holds; the others stay empty. forEachColumn calls
+// visit(position, name, column) for every column the table can hold, held or not.
+
+struct LineitemTable {
+    static constexpr int OrderkeyColumn = 0;
+    static constexpr int SuppkeyColumn = 2;
+    static constexpr int QuantityColumn = 4;
+    static constexpr int ExtendedpriceColumn = 5;
+    static constexpr int DiscountColumn = 6;
+    static constexpr int TaxColumn = 7;
+    static constexpr int ReturnflagColumn = 8;
+    static constexpr int LinestatusColumn = 9;
+    static constexpr int ShipdateColumn = 10;
+    static constexpr ColumnSet DefaultColumns = columnBit(OrderkeyColumn) | columnBit(SuppkeyColumn) |
+                                                columnBit(ExtendedpriceColumn) | columnBit(DiscountColumn);
+    static constexpr ColumnSet AllColumns = DefaultColumns | columnBit(QuantityColumn) | columnBit(TaxColumn) |
+                                            columnBit(ReturnflagColumn) | columnBit(LinestatusColumn) |
+                                            columnBit(ShipdateColumn);
+
+    Column<int> orderkey;
+    Column<Money> extendedprice;
+    Column<Money> discount;
+    Column<int> suppkey;
+    Column<Money> quantity;
+    Column<Money> tax;
+    Column<char> returnflag;
+    Column<char> linestatus;
+    Column<int32_t> shipdate;
+    ColumnSet columns = DefaultColumns;
+    size_t rowCount = 0;
+
+    size_t size() const { return rowCount; }
+    bool empty() const { return rowCount == 0; }
+    bool has(int position) const { return (columns & columnBit(position)) != 0; }
+
+    template <typename Visit>
+    void forEachColumn(Visit visit) { visitColumns(*this, visit); }
+    template <typename Visit>
+    void forEachColumn(Visit visit) const { visitColumns(*this, visit); }
+
+    void reserve(size_t n) {
+        forEachColumn([&](int position, const char *, auto &column) {
+            if (has(position))
+                column.reserve(n);
+        });
+    }
+
+    void push_back(const Lineitem &l) {
+        if (has(OrderkeyColumn))
+            orderkey.push_back(l.orderkey);
+        if (has(ExtendedpriceColumn))
+            extendedprice.push_back(l.extendedprice);
+        if (has(DiscountColumn))
+            discount.push_back(l.discount);
+        if (has(SuppkeyColumn))
+            suppkey.push_back(l.suppkey);
+        if (has(QuantityColumn))
+            quantity.push_back(l.quantity);
+        if (has(TaxColumn))
+            tax.push_back(l.tax);
+        if (has(ReturnflagColumn))
+            returnflag.push_back(l.returnflag);
+        if (has(LinestatusColumn))
+            linestatus.push_back(l.linestatus);
+        if (has(ShipdateColumn))
+            shipdate.push_back(l.shipdate);
+        ++rowCount;
+    }
+
+    void append(const LineitemTable &other) {
+        appendColumn(orderkey, other.orderkey);
+        appendColumn(extendedprice, other.extendedprice);
+        appendColumn(discount, other.discount);
+        appendColumn(suppkey, other.suppkey);
+        appendColumn(quantity, other.quantity);
+        appendColumn(tax, other.tax);
+        appendColumn(returnflag, other.returnflag);
+        appendColumn(linestatus, other.linestatus);
+        appendColumn(shipdate, other.shipdate);
+        rowCount += other.rowCount;
+    }
+
+    // Drops the rows but keeps the column selection and the capacity of owned columns.
+    void clear() {
+        forEachColumn([](int, const char *, auto &column) { column.clear(); });
+        rowCount = 0;
+    }
+
+    // Columns the table does not hold read as zero.
+    Lineitem operator[](size_t i) const {
+        Lineitem l{};
+        if (has(OrderkeyColumn))
+            l.orderkey = orderkey[i];
+        if (has(ExtendedpriceColumn))
+            l.extendedprice = extendedprice[i];
+        if (has(DiscountColumn))
+            l.discount = discount[i];
+        if (has(SuppkeyColumn))
+            l.suppkey = suppkey[i];
+        if (has(QuantityColumn))
+            l.quantity = quantity[i];
+        if (has(TaxColumn))
+            l.tax = tax[i];
+        if (has(ReturnflagColumn))
+            l.returnflag = returnflag[i];
+        if (has(LinestatusColumn))
+            l.linestatus = linestatus[i];
+        if (has(ShipdateColumn))
+            l.shipdate = shipdate[i];
+        return l;
+    }
+
+private:
+    template <typename Table, typename Visit>
+    static void visitColumns(Table &t, Visit &visit) {
+        visit(OrderkeyColumn, "l_orderkey", t.orderkey);
+        visit(SuppkeyColumn, "l_suppkey", t.suppkey);
+        visit(QuantityColumn, "l_quantity", t.quantity);
+        visit(ExtendedpriceColumn, "l_extendedprice", t.extendedprice);
+        visit(DiscountColumn, "l_discount", t.discount);
+        visit(TaxColumn, "l_tax", t.tax);
+        visit(ReturnflagColumn, "l_returnflag", t.returnflag);
+        visit(LinestatusColumn, "l_linestatus", t.linestatus);
+        visit(ShipdateColumn, "l_shipdate", t.shipdate);
+    }
+};
+
+struct OrdersTable {
+    static constexpr int OrderkeyColumn = 0;
+    static constexpr int CustkeyColumn = 1;
+    static constexpr int OrderdateColumn = 4;
+    static constexpr ColumnSet DefaultColumns = columnBit(OrderkeyColumn) | columnBit(CustkeyColumn) | columnBit(OrderdateColumn);
+    static constexpr ColumnSet AllColumns = DefaultColumns;
+
+    Column<int> orderkey;
+    Column<int> custkey;
+    Column<int32_t> orderdate;
+    ColumnSet columns = DefaultColumns;
+    size_t rowCount = 0;
+
+    size_t size() const { return rowCount; }
+    bool empty() const { return rowCount == 0; }
+    bool has(int position) const { return (columns & columnBit(position)) != 0; }
+
+    template <typename Visit>
+    void forEachColumn(Visit visit) { visitColumns(*this, visit); }
+    template <typename Visit>
+    void forEachColumn(Visit visit) const { visitColumns(*this, visit); }
+
+    void reserve(size_t n) {
+        forEachColumn([&](int position, const char *, auto &column) {
+            if (has(position))
+                column.reserve(n);
+        });
+    }
+
+    void push_back(const Orders &o) {
+        if (has(OrderkeyColumn))
+            orderkey.push_back(o.orderkey);
+        if (has(CustkeyColumn))
+            custkey.push_back(o.custkey);
+        if (has(OrderdateColumn))
+            orderdate.push_back(o.orderdate);
+        ++rowCount;
+    }
+
+    void append(const OrdersTable &other) {
+        appendColumn(orderkey, other.orderkey);
+        appendColumn(custkey, other.custkey);
+        appendColumn(orderdate, other.orderdate);
+        rowCount += other.rowCount;
+    }
+
+    Orders operator[](size_t i) const {
+        return Orders{has(OrderkeyColumn) ? orderkey[i] : 0, has(CustkeyColumn) ? custkey[i] : 0,
+                      has(OrderdateColumn) ? orderdate[i] : 0};
+    }
+
+private:
+    template <typename Table, typename Visit>
+    static void visitColumns(Table &t, Visit &visit) {
+        visit(OrderkeyColumn, "o_orderkey", t.orderkey);
+        visit(CustkeyColumn, "o_custkey", t.custkey);
+        visit(OrderdateColumn, "o_orderdate", t.orderdate);
+    }
+};
+
+struct CustomerTable {
+    static constexpr int CustkeyColumn = 0;
+    static constexpr int NationkeyColumn = 3;
+    static constexpr ColumnSet DefaultColumns = columnBit(CustkeyColumn) | columnBit(NationkeyColumn);
+    static constexpr ColumnSet AllColumns = DefaultColumns;
+
+    Column<int> custkey;
+    Column<int> nationkey;
+    ColumnSet columns = DefaultColumns;
+    size_t rowCount = 0;
+
+    size_t size() const { return rowCount; }
+    bool empty() const { return rowCount == 0; }
+    bool has(int position) const { return (columns & columnBit(position)) != 0; }
+
+    template <typename Visit>
+    void forEachColumn(Visit visit) { visitColumns(*this, visit); }
+    template <typename Visit>
+    void forEachColumn(Visit visit) const { visitColumns(*this, visit); }
+
+    void reserve(size_t n) {
+        forEachColumn([&](int position, const char *, auto &column) {
+            if (has(position))
+                column.reserve(n);
+        });
+    }
+
+    void push_back(const Customer &c) {
+        if (has(CustkeyColumn))
+            custkey.push_back(c.custkey);
+        if (has(NationkeyColumn))
+            nationkey.push_back(c.nationkey);
+        ++rowCount;
+    }
+
+    void append(const CustomerTable &other) {
+        appendColumn(custkey, other.custkey);
+        appendColumn(nationkey, other.nationkey);
+        rowCount += other.rowCount;
+    }
+
+    Customer operator[](size_t i) const {
+        return Customer{has(CustkeyColumn) ? custkey[i] : 0, has(NationkeyColumn) ? nationkey[i] : 0};
+    }
+
+private:
+    template <typename Table, typename Visit>
+    static void visitColumns(Table &t, Visit &visit) {
+        visit(CustkeyColumn, "c_custkey", t.custkey);
+        visit(NationkeyColumn, "c_nationkey", t.nationkey);
+    }
+};
+
+struct SupplierTable {
+    static constexpr int SuppkeyColumn = 0;
+    static constexpr int NationkeyColumn = 3;
+    static constexpr ColumnSet DefaultColumns = columnBit(SuppkeyColumn) | columnBit(NationkeyColumn);
+    static constexpr ColumnSet AllColumns = DefaultColumns;
+
+    Column<int> suppkey;
+    Column<int> nationkey;
+    ColumnSet columns = DefaultColumns;
+    size_t rowCount = 0;
+
+    size_t size() const { return rowCount; }
+    bool empty() const { return rowCount == 0; }
+    bool has(int position) const { return (columns & columnBit(position)) != 0; }
+
+    template <typename Visit>
+    void forEachColumn(Visit visit) { visitColumns(*this, visit); }
+    template <typename Visit>
+    void forEachColumn(Visit visit) const { visitColumns(*this, visit); }
+
+    void reserve(size_t n) {
+        forEachColumn([&](int position, const char *, auto &column) {
+            if (has(position))
+                column.reserve(n);
+        });
+    }
+
+    void push_back(const Supplier &s) {
+        if (has(SuppkeyColumn))
+            suppkey.push_back(s.suppkey);
+        if (has(NationkeyColumn))
+            nationkey.push_back(s.nationkey);
+        ++rowCount;
+    }
+
+    void append(const SupplierTable &other) {
+        appendColumn(suppkey, other.suppkey);
+        appendColumn(nationkey, other.nationkey);
+        rowCount += other.rowCount;
+    }
+
+    Supplier operator[](size_t i) const {
+        return Supplier{has(SuppkeyColumn) ? suppkey[i] : 0, has(NationkeyColumn) ? nationkey[i] : 0};
+    }
+
+private:
+    template <typename Table, typename Visit>
+    static void visitColumns(Table &t, Visit &visit) {
+        visit(SuppkeyColumn, "s_suppkey", t.suppkey);
+        visit(NationkeyColumn, "s_nationkey", t.nationkey);
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <initializer_list>
+
+// Runtime selection of SIMD kernels. A translation unit compiles its wider kernels with
+// __attribute__((target(...))) inside #ifdef CPU_DISPATCH_X86 and picks one per process with
+// selectKernel, so the binary runs on any x86-64 and uses AVX2 where the CPU has it.
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_DISPATCH_X86 1
+#endif
+
+enum class CpuFeature {
+    Sse42,
+    Avx2
+};
+
+// True if the running CPU supports feature; always false off x86.
+inline bool cpuSupports(CpuFeature feature) {
+#ifdef CPU_DISPATCH_X86
+    __builtin_cpu_init();
+    switch (feature) {
+    case CpuFeature::Sse42:
+        return __builtin_cpu_supports("sse4.2");
+    case CpuFeature::Avx2:
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    (void)feature;
+    return false;
+}
+
+inline const char *cpuFeatureName(CpuFeature feature) {
+    return feature == CpuFeature::Avx2 ? "avx2" : "sse4.2";
+}
+
+// A kernel and the name reported for it ("avx2", "sse4.2" or "scalar").
+template <typename Kernel>
+struct KernelChoice {
+    Kernel kernel;
+    const char *name;
+};
+
+template <typename Kernel>
+struct KernelCandidate {
+    CpuFeature feature;
+    Kernel kernel;
+};
+
+// The first of candidates (listed widest first) whose feature the CPU supports, or the scalar
+// fallback. Callers keep the result in a function-local static so the CPU is queried once.
+template <typename Kernel>
+KernelChoice<Kernel> selectKernel(std::initializer_list<KernelCandidate<Kernel>> candidates, Kernel fallback) {
+    for (const KernelCandidate<Kernel> &candidate : candidates) {
+        if (cpuSupports(candidate.feature))
+            return {candidate.kernel, cpuFeatureName(candidate.feature)};
+    }
+    return {fallback, "scalar"};
+}
@@ -1,57 +1,73 @@
 #pragma once
 
+#include "columnar_table.hpp"
+#include <functional>
 #include <vector>
 #include <string>
 
-// Record structures for TPC-H tables.
+class ThreadPool;
 
-// Customer: c_custkey (index 0) and c_nationkey (index 3)
-struct Customer {
-    int custkey;
-    int nationkey;
+// How a table file is read.
+// Stream: std::ifstream + std::getline, one std::string per line.
+// Mmap:   the file is memory mapped and fields are parsed in place. When a ThreadPool is
+//         passed to a loader, large files are split at line boundaries and the chunks are
+//         parsed concurrently on the pool. The loader waits for those chunks, so it must not
+//         itself be running on one of the pool's workers.
+enum class LoadMethod {
+    Stream,
+    Mmap
 };
 
-// Orders: o_orderkey (index 0), o_custkey (index 1), o_orderdate (index 4)
-struct Orders {
-    int orderkey;
-    int custkey;
-    std::string orderdate;
+// The columns to load from each columnar table, as sets of .tbl positions (e.g.
+// columnBit(LineitemTable::ShipdateColumn)). A query declares the columns it reads (see
+// q5Columns); the loaders parse only those and skip the other fields of a row by counting
+// delimiters. Positions a table cannot hold are ignored. DataManager skips the lineitem file
+// when no lineitem column is selected. Nation and region are always loaded whole. The
+// defaults are the columns Q5 reads.
+struct ColumnSelection {
+    ColumnSet customer = CustomerTable::DefaultColumns;
+    ColumnSet orders = OrdersTable::DefaultColumns;
+    ColumnSet lineitem = LineitemTable::DefaultColumns;
+    ColumnSet supplier = SupplierTable::DefaultColumns;
 };
 
-// Lineitem: l_orderkey (index 0), l_extendedprice (index 5), l_discount (index 6), l_suppkey (index 2)
-struct Lineitem {
-    int orderkey;
-    double extendedprice;
-    double discount;
-    int suppkey;
+struct LoadOptions {
+    LoadMethod method = LoadMethod::Mmap;
+    // Numeric and date fields are parsed with fixed-format parsers that trust their input.
+    // With validate set every field is checked first; malformed rows are reported and skipped.
+    bool validate = false;
+    ColumnSelection columns;
+    // After a text load DataManager encodes each integer and decimal column of the scanned
+    // tables (frame of reference or dictionary, bit-packed) when that makes it smaller.
+    bool compress = true;
+    // Binary snapshot file (see table_snapshot.hpp). When set, DataManager maps the tables from
+    // it if it is valid for the current source files, and otherwise loads the text files and
+    // writes it for the next start.
+    std::string snapshot;
+    // Check every snapshot column against its checksum when mapping it (on the pool). This reads
+    // the whole file up front; turning it off leaves only the header, directory, fingerprint
+    // and dictionary-code checks, and a damaged column then goes unnoticed.
+    bool verifySnapshot = true;
 };
 
-// Supplier: s_suppkey (index 0), s_nationkey (index 3)
-struct Supplier {
-    int suppkey;
-    int nationkey;
-};
+class DataLoader {
+public:
+    // Receives one batch of parsed lineitem rows on the pool worker that parsed it.
+    using LineitemConsumer = std::function<void(size_t worker, const LineitemTable &batch)>;
 
-// Nation: n_nationkey (index 0), n_name (index 1), n_regionkey (index 2)
-struct Nation {
-    int nationkey;
-    std::string name;
-    int regionkey;
-};
+    static CustomerTable loadCustomerData(const std::string &filePath, const LoadOptions &options = {}, ThreadPool *pool = nullptr);
+    static OrdersTable loadOrdersData(const std::string &filePath, const LoadOptions &options = {}, ThreadPool *pool = nullptr);
+    static LineitemTable loadLineitemData(const std::string &filePath, const LoadOptions &options = {}, ThreadPool *pool = nullptr);
+    static SupplierTable loadSupplierData(const std::string &filePath, const LoadOptions &options = {}, ThreadPool *pool = nullptr);
+    static std::vector<Nation> loadNationData(const std::string &filePath, const LoadOptions &options = {}, ThreadPool *pool = nullptr);
+    static std::vector<Region> loadRegionData(const std::string &filePath, const LoadOptions &options = {}, ThreadPool *pool = nullptr);
 
-// Region: r_regionkey (index 0), r_name (index 1)
-struct Region {
-    int regionkey;
-    std::string name;
+    // Parses lineitem without keeping it. The file is mapped and cut into line-aligned chunks
+    // that are parsed concurrently on pool; every batchRows parsed rows (fewer at the end of a
+    // chunk) are passed to consume(worker, batch) and then dropped, and the pages of a parsed
+    // chunk are released. worker is below pool.size() and is used by one running task at a
+    // time, so it can index per-worker state. The file is mapped whatever options.method says.
+    // Waits for the chunks, so it must not run on a pool worker. Returns the rows parsed.
+    static size_t streamLineitemData(const std::string &filePath, const LoadOptions &options, ThreadPool &pool,
+                                     size_t batchRows, const LineitemConsumer &consume);
 };
-
-class DataLoader {
-public:
-    static std::vector<Customer> loadCustomerData(const std::string &filePath);
-    static std::vector<Orders> loadOrdersData(const std::string &filePath);
-    static std::vector<Lineitem> loadLineitemData(const std::string &filePath);
-    static std::vector<Supplier> loadSupplierData(const std::string &filePath);
-    static std::vector<Nation> loadNationData(const std::string &filePath);
-    static std::vector<Region> loadRegionData(const std::string &filePath);
-    static std::vector<std::string> splitLine(const std::string &line, char delimiter='|');
-};
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "data_loader.hpp"
+#include "join_index.hpp"
+#include "zone_map.hpp"
 #include <vector>
 #include <string>
 #include <queue>
@@ -11,13 +13,19 @@
 
 class DataManager {
 public:
-    // Data storage for each table.
-    std::vector<Customer> customers;
-    std::vector<Orders> orders;
-    std::vector<Lineitem> lineitems;
-    std::vector<Supplier> suppliers;
+    // Data storage for each table. The scanned tables are columnar; indexing them
+    // (e.g. lineitems[i]) still yields the row structs.
+    CustomerTable customers;
+    OrdersTable orders;
+    LineitemTable lineitems;
+    SupplierTable suppliers;
     std::vector<Nation> nations;
     std::vector<Region> regions;
+
+    // Primary-key join indexes, built by loadAllTables and shared by all queries.
+    JoinCatalog indexes;
+    // Per-block min/max of the scanned tables' columns, built by loadAllTables.
+    ZoneMapCatalog zoneMaps;
     
     bool dataLoaded;
     std::mutex mtx;
@@ -39,8 +47,27 @@ public:
                 const std::string &lineF, const std::string &suppF,
                 const std::string &natF, const std::string &regF,const int threads);
     
-    void loadAllTables();
+    // Loads all six tables in parallel using the given loader options.
+    void loadAllTables(const LoadOptions &options = {});
+    // (Re)builds indexes from the loaded tables.
+    void buildJoinIndexes();
+    // (Re)builds the zone maps from the loaded tables.
+    void buildZoneMaps();
+    // Maps the tables from a binary snapshot; false (with a message on stderr) if the file is
+    // missing, corrupt or was written from other source files or options.
+    bool loadSnapshot(const std::string &path, const LoadOptions &options);
+    // Writes the loaded tables as a binary snapshot.
+    bool writeSnapshot(const std::string &path, const LoadOptions &options) const;
     void processQuery(std::function<void()> query);
     void processQueuedQueries();
+
+private:
+    void loadTextTables(const LoadOptions &options);
+    // Encodes the columns of the scanned tables (LoadOptions::compress) and reports the sizes.
+    void encodeTables();
+    // Identifies the source files (paths, sizes, modification times) and the options that
+    // affect their parsed contents. False (with error set) if a source file cannot be
+    // stat()ed, in which case no snapshot can be matched to it.
+    bool snapshotFingerprint(const LoadOptions &options, uint64_t &fingerprint, std::string &error) const;
 };
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Exact fixed-point decimal: an int64 count of 10^-Scale units, e.g. Decimal<2>{3690160} is
+// 36901.60. Sums and products of TPC-H money values stay exact, so a result does not depend on
+// the order rows are added in (thread count, partitioning), and integer columns vectorize.
+// int64 covers +-9.2e18 units, i.e. +-9.2e14 at Scale 4, well above any Q5 revenue group.
+template <unsigned Scale>
+struct Decimal {
+    int64_t units = 0;
+
+    static constexpr int64_t unitsPerOne() {
+        int64_t one = 1;
+        for (unsigned i = 0; i < Scale; i++)
+            one *= 10;
+        return one;
+    }
+
+    Decimal &operator+=(Decimal other) {
+        units += other.units;
+        return *this;
+    }
+    friend Decimal operator+(Decimal a, Decimal b) { return Decimal{a.units + b.units}; }
+    friend bool operator==(Decimal a, Decimal b) { return a.units == b.units; }
+    friend bool operator!=(Decimal a, Decimal b) { return a.units != b.units; }
+    friend bool operator<(Decimal a, Decimal b) { return a.units < b.units; }
+    friend bool operator>(Decimal a, Decimal b) { return a.units > b.units; }
+
+    // Fixed notation with `digits` fraction digits: exact when digits >= Scale (zero padded),
+    // otherwise rounded half away from zero. format(6) matches std::to_string on a double.
+    std::string format(unsigned digits) const {
+        bool negative = units < 0;
+        uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+        unsigned kept = Scale;
+        if (digits < Scale) {
+            // Drop the extra digits with one division so the value is rounded only once.
+            uint64_t dropped = 1;
+            for (; kept > digits; kept--)
+                dropped *= 10;
+            magnitude = magnitude / dropped + (magnitude % dropped >= dropped / 2);
+        }
+        uint64_t one = 1;
+        for (unsigned i = 0; i < kept; i++)
+            one *= 10;
+        std::string out = negative && magnitude != 0 ? "-" : "";
+        out += std::to_string(magnitude / one);
+        if (digits == 0)
+            return out;
+        out += '.';
+        if (kept > 0) {
+            std::string fraction = std::to_string(magnitude % one);
+            out.append(kept - fraction.size(), '0');
+            out += fraction;
+        }
+        out.append(digits - kept, '0');
+        return out;
+    }
+};
+
+// Prices and discounts: two fraction digits, as dbgen writes them (parseDecimal2).
+using Money = Decimal<2>;
+
+// l_extendedprice * (1 - l_discount), exactly: hundredths times hundredths is Decimal<4>.
+inline Decimal<4> discountedPrice(Money price, Money discount) {
+    return Decimal<4>{price.units * (Money::unitsPerOne() - discount.units)};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Bitmasks of delimiter positions in one 64-byte block: bit i is set when byte i matches.
+struct DelimiterMasks {
+    uint64_t field;
+    uint64_t line;
+};
+
+// Computes the masks for the 64 bytes starting at block.
+using DelimiterKernel = DelimiterMasks (*)(const char *block, char fieldDelimiter, char lineDelimiter);
+
+// The widest kernel supported by the running CPU (AVX2, SSE4.2 or scalar), selected once.
+DelimiterKernel delimiterKernel();
+const char *delimiterKernelName();
+
+// Walks a buffer delimiter by delimiter using the block masks, in the spirit of simdjson's
+// structural index: each 64-byte block is classified once, after which every field or line
+// boundary is a count-trailing-zeros away.
+class DelimiterCursor {
+public:
+    static constexpr size_t BlockSize = 64;
+
+    DelimiterCursor(const char *begin, const char *end, char fieldDelimiter = '|', char lineDelimiter = '\n')
+        : base(begin), limit(end), pos(begin), fieldDelimiter(fieldDelimiter), lineDelimiter(lineDelimiter),
+          kernel(delimiterKernel()) {
+        scan();
+    }
+
+    const char *position() const { return pos; }
+    const char *end() const { return limit; }
+    bool atEnd() const { return pos >= limit; }
+
+    // True if d (as returned by next/nextLine) terminates the current line.
+    bool isLineEnd(const char *d) const { return d == limit || *d == lineDelimiter; }
+
+    // Returns the next field or line delimiter at or after position() and moves past it.
+    // Returns end() when the buffer holds no further delimiter.
+    const char *next() {
+        while ((masks.field | masks.line) == 0) {
+            if (!advance())
+                return finish();
+        }
+        return consume(static_cast<unsigned>(__builtin_ctzll(masks.field | masks.line)));
+    }
+
+    // Like next(), but skips field delimiters and stops only at the end of the line.
+    const char *nextLine() {
+        while (masks.line == 0) {
+            if (!advance())
+                return finish();
+        }
+        return consume(static_cast<unsigned>(__builtin_ctzll(masks.line)));
+    }
+
+    // Moves past the next n delimiters (n >= 1) at once: whole blocks are counted with popcount
+    // instead of being walked delimiter by delimiter. Stops early at the end of the line.
+    // Returns the last delimiter passed (the line delimiter if the line ended first), or end().
+    const char *skip(unsigned n) {
+        for (;;) {
+            uint64_t lineBit = masks.line & (0 - masks.line);
+            // Field delimiters before the first line delimiter, and that line delimiter.
+            uint64_t candidates = (masks.field | masks.line) & (lineBit ? (lineBit << 1) - 1 : ~0ULL);
+            unsigned count = static_cast<unsigned>(__builtin_popcountll(candidates));
+            if (count >= n) {
+                for (unsigned i = 1; i < n; ++i)
+                    candidates &= candidates - 1;
+                return consume(static_cast<unsigned>(__builtin_ctzll(candidates)));
+            }
+            if (lineBit != 0)
+                return consume(static_cast<unsigned>(__builtin_ctzll(lineBit)));
+            n -= count;
+            if (!advance())
+                return finish();
+        }
+    }
+
+private:
+    bool advance() {
+        blockOffset += BlockSize;
+        if (blockOffset >= static_cast<size_t>(limit - base))
+            return false;
+        scan();
+        return true;
+    }
+
+    const char *finish() {
+        pos = limit;
+        masks = {0, 0};
+        return limit;
+    }
+
+    const char *consume(unsigned bit) {
+        const char *d = base + blockOffset + bit;
+        uint64_t keep = bit == 63 ? 0 : ~0ULL << (bit + 1);
+        masks.field &= keep;
+        masks.line &= keep;
+        pos = d + 1;
+        return d;
+    }
+
+    void scan() {
+        size_t remaining = static_cast<size_t>(limit - base) - blockOffset;
+        if (remaining >= BlockSize) {
+            masks = kernel(base + blockOffset, fieldDelimiter, lineDelimiter);
+            return;
+        }
+        // Short tail: classify a padded copy and drop the bits past the end of the buffer.
+        char tail[BlockSize] = {};
+        std::memcpy(tail, base + blockOffset, remaining);
+        masks = kernel(tail, fieldDelimiter, lineDelimiter);
+        uint64_t valid = (1ULL << remaining) - 1;
+        masks.field &= valid;
+        masks.line &= valid;
+    }
+
+    const char *base;
+    const char *limit;
+    const char *pos;
+    size_t blockOffset = 0;
+    DelimiterMasks masks = {0, 0};
+    char fieldDelimiter;
+    char lineDelimiter;
+    DelimiterKernel kernel;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Parsers for the fixed formats used by dbgen's .tbl files.
+// The parseX functions assume well-formed input and do no checking at all; the tryParseX
+// variants reject anything that is not exactly the expected format.
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// Optional '-' followed by decimal digits.
+inline int32_t parseInt32(std::string_view s) {
+    const char *p = s.data();
+    const char *end = p + s.size();
+    bool negative = p < end && *p == '-';
+    p += negative;
+    uint32_t value = 0;
+    for (; p < end; ++p)
+        value = value * 10 + static_cast<uint32_t>(*p - '0');
+    return negative ? -static_cast<int32_t>(value) : static_cast<int32_t>(value);
+}
+
+inline bool tryParseInt32(std::string_view s, int32_t &out) {
+    const char *p = s.data();
+    const char *end = p + s.size();
+    bool negative = p < end && *p == '-';
+    p += negative;
+    if (p == end || end - p > 10)
+        return false;
+    int64_t value = 0;
+    for (; p < end; ++p) {
+        if (!isDigit(*p))
+            return false;
+        value = value * 10 + (*p - '0');
+    }
+    value = negative ? -value : value;
+    if (value < INT32_MIN || value > INT32_MAX)
+        return false;
+    out = static_cast<int32_t>(value);
+    return true;
+}
+
+// Decimal with up to two fraction digits ("1234.5", "-0.07", "12") as an integer count of
+// hundredths, e.g. "36901.60" -> 3690160.
+inline int64_t parseDecimal2(std::string_view s) {
+    const char *p = s.data();
+    const char *end = p + s.size();
+    bool negative = p < end && *p == '-';
+    p += negative;
+    int64_t whole = 0;
+    for (; p < end && *p != '.'; ++p)
+        whole = whole * 10 + (*p - '0');
+    int64_t fraction = 0;
+    int digits = 0;
+    if (p < end) {
+        for (++p; p < end && digits < 2; ++p, ++digits)
+            fraction = fraction * 10 + (*p - '0');
+    }
+    for (; digits < 2; ++digits)
+        fraction *= 10;
+    int64_t value = whole * 100 + fraction;
+    return negative ? -value : value;
+}
+
+inline bool tryParseDecimal2(std::string_view s, int64_t &out) {
+    const char *p = s.data();
+    const char *end = p + s.size();
+    bool negative = p < end && *p == '-';
+    p += negative;
+    const char *wholeBegin = p;
+    int64_t whole = 0;
+    for (; p < end && *p != '.'; ++p) {
+        if (!isDigit(*p) || p - wholeBegin >= 16)
+            return false;
+        whole = whole * 10 + (*p - '0');
+    }
+    if (p == wholeBegin)
+        return false;
+    int64_t fraction = 0;
+    int digits = 0;
+    if (p < end) {
+        for (++p; p < end; ++p, ++digits) {
+            if (!isDigit(*p) || digits == 2)
+                return false;
+            fraction = fraction * 10 + (*p - '0');
+        }
+        if (digits == 0)
+            return false;
+    }
+    for (; digits < 2; ++digits)
+        fraction *= 10;
+    int64_t value = whole * 100 + fraction;
+    out = negative ? -value : value;
+    return true;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's days_from_civil).
+inline int32_t daysFromCivil(int32_t year, int32_t month, int32_t day) {
+    year -= month <= 2;
+    const int32_t era = (year >= 0 ? year : year - 399) / 400;
+    const int32_t yearOfEra = year - era * 400;
+    const int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// YYYY-MM-DD as days since 1970-01-01. s must hold at least 10 characters; callers check
+// the size, as a short field would make this read past its end.
+inline int32_t parseDate(std::string_view s) {
+    const char *p = s.data();
+    int32_t year = (p[0] - '0') * 1000 + (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+    int32_t month = (p[5] - '0') * 10 + (p[6] - '0');
+    int32_t day = (p[8] - '0') * 10 + (p[9] - '0');
+    return daysFromCivil(year, month, day);
+}
+
+inline bool tryParseDate(std::string_view s, int32_t &out) {
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-')
+        return false;
+    static const int digitPositions[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+    for (int i : digitPositions) {
+        if (!isDigit(s[static_cast<size_t>(i)]))
+            return false;
+    }
+    int32_t year = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 + (s[3] - '0');
+    int32_t month = (s[5] - '0') * 10 + (s[6] - '0');
+    int32_t day = (s[8] - '0') * 10 + (s[9] - '0');
+    static const int32_t daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth[month - 1] + (month == 2 && leap))
+        return false;
+    out = daysFromCivil(year, month, day);
+    return true;
+}
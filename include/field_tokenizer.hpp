@@ -0,0 +1,76 @@
+#pragma once
+
+#include "delimiter_scanner.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Extracts a set of delimiter-separated columns from one row without allocating.
+// Only the requested columns are returned (as views into the row). Columns between them are
+// skipped with one delimiter count (DelimiterCursor::skip) and scanning stops at the end of
+// the last requested column; the rest of the row is skipped as a whole.
+// N is the most columns a tokenizer can return; fromSet picks them at run time.
+template <size_t N>
+class FieldTokenizer {
+public:
+    // columns holds zero-based column indices in strictly increasing order.
+    explicit constexpr FieldTokenizer(const std::array<int, N> &columns, char delimiter = '|')
+        : columns(columns), count(N), delimiter(delimiter) {}
+
+    // The columns whose bits are set in set (bit i for column i), at most N of them.
+    static FieldTokenizer fromSet(uint32_t set, char delimiter = '|') {
+        std::array<int, N> columns{};
+        size_t count = 0;
+        for (int column = 0; column < 32 && count < N; ++column) {
+            if (set & (uint32_t(1) << column))
+                columns[count++] = column;
+        }
+        FieldTokenizer tokenizer(columns, delimiter);
+        tokenizer.count = count;
+        return tokenizer;
+    }
+
+    // Number of columns returned per row.
+    size_t size() const { return count; }
+
+    // Reads the row starting at cursor.position() and leaves the cursor at the start of the
+    // next row. Returns false (after consuming the row) if it is empty or too short.
+    // A delimiter at the very end of a row does not start another (empty) column.
+    bool next(DelimiterCursor &cursor, std::array<std::string_view, N> &fields) const {
+        const char *p = cursor.position();
+        int column = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (column < columns[i]) {
+                const char *d = cursor.skip(static_cast<unsigned>(columns[i] - column));
+                if (cursor.isLineEnd(d))
+                    return false;
+                p = d + 1;
+                column = columns[i];
+            }
+            const char *d = cursor.next();
+            if (cursor.isLineEnd(d)) {
+                if (d == p)
+                    return false;
+                fields[i] = std::string_view(p, static_cast<size_t>(d - p));
+                return i + 1 == count;
+            }
+            fields[i] = std::string_view(p, static_cast<size_t>(d - p));
+            p = d + 1;
+            ++column;
+        }
+        cursor.nextLine();
+        return true;
+    }
+
+    // Tokenizes a single row held on its own (no line delimiter).
+    bool tokenize(std::string_view line, std::array<std::string_view, N> &fields) const {
+        DelimiterCursor cursor(line.data(), line.data() + line.size(), delimiter);
+        return next(cursor, fields);
+    }
+
+private:
+    std::array<int, N> columns;
+    size_t count;
+    char delimiter;
+};
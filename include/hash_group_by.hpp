@@ -0,0 +1,142 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Parallel group-by on int keys for high-cardinality groupings (orderkey, custkey, ...).
+// Each task pre-aggregates into its own open-addressing table, sized to stay in the L2 cache.
+// When the table fills up it is spilled: its groups are scattered into 2^PartitionBits radix
+// partitions (top bits of a multiplicative hash) and the table starts over empty. merge()
+// spills what is left, then aggregates each partition across all tasks as an independent pool
+// task, so the final merge is parallel instead of one thread folding every task's map.
+// Small, dense domains (e.g. nation rows) are better served by SmallGroupBy.
+// merge() waits for the tasks it submits, so it must be called from outside the pool.
+template <typename Value>
+class HashGroupBy {
+public:
+    struct Group {
+        int key;
+        Value sum;
+        uint64_t rows;
+    };
+
+    // Pre-aggregation state of one task; only that task may call add().
+    class alignas(64) Local {
+    public:
+        Local() : table(LocalSlots), spilled(Partitions) {}
+
+        void add(int key, Value value) {
+            uint32_t h = hash(key);
+            for (size_t slot = h & (LocalSlots - 1);; slot = (slot + 1) & (LocalSlots - 1)) {
+                Group &group = table[slot];
+                if (group.rows == 0) {
+                    group = Group{key, value, 1};
+                    if (++used > LocalSlots / 2)
+                        spill();
+                    return;
+                }
+                if (group.key == key) {
+                    group.sum += value;
+                    group.rows++;
+                    return;
+                }
+            }
+        }
+
+    private:
+        friend class HashGroupBy;
+
+        // Moves every group in the table to its radix partition and empties the table.
+        void spill() {
+            for (Group &group : table) {
+                if (group.rows != 0) {
+                    spilled[partitionOf(group.key)].push_back(group);
+                    group = Group{};
+                }
+            }
+            used = 0;
+        }
+
+        std::vector<Group> table;
+        std::vector<std::vector<Group>> spilled;
+        size_t used = 0;
+    };
+
+    HashGroupBy(ThreadPool &pool, size_t tasks) : pool(pool), locals(std::max<size_t>(1, tasks)) {}
+
+    size_t taskCount() const { return locals.size(); }
+    Local &local(size_t task) { return locals[task]; }
+    void add(size_t task, int key, Value value) { locals[task].add(key, value); }
+
+    // Combines all tasks' groups. Groups come out ordered by partition, unordered within one;
+    // each key's sum adds the tasks' partial sums in task order. Leaves the operator empty.
+    std::vector<Group> merge() {
+        for (Local &local : locals)
+            local.spill();
+
+        std::vector<std::vector<Group>> merged(Partitions);
+        pool.parallelFor(Partitions, [&](size_t p) { merged[p] = mergePartition(p); });
+
+        std::vector<Group> out;
+        size_t total = 0;
+        for (const auto &groups : merged)
+            total += groups.size();
+        out.reserve(total);
+        for (const auto &groups : merged)
+            out.insert(out.end(), groups.begin(), groups.end());
+        return out;
+    }
+
+private:
+    // 8K slots of a 24-byte group (int key, double sum, row count) is 192 KB, about one L2.
+    static constexpr size_t LocalSlots = 8192;
+    static constexpr unsigned PartitionBits = 6;
+    static constexpr size_t Partitions = size_t(1) << PartitionBits;
+
+    static uint32_t hash(int key) { return static_cast<uint32_t>(key) * 2654435761u; }
+    static size_t partitionOf(int key) { return hash(key) >> (32 - PartitionBits); }
+
+    // Aggregates partition p of every task into one open-addressing table.
+    std::vector<Group> mergePartition(size_t p) {
+        size_t count = 0;
+        for (const Local &local : locals)
+            count += local.spilled[p].size();
+        size_t capacity = 16;
+        while (capacity < 2 * count)
+            capacity <<= 1;
+        const size_t mask = capacity - 1;
+
+        std::vector<Group> table(capacity);
+        size_t distinct = 0;
+        for (Local &local : locals) {
+            for (const Group &partial : local.spilled[p]) {
+                size_t slot = hash(partial.key) & mask;
+                while (table[slot].rows != 0 && table[slot].key != partial.key)
+                    slot = (slot + 1) & mask;
+                Group &group = table[slot];
+                if (group.rows == 0) {
+                    group = partial;
+                    distinct++;
+                } else {
+                    group.sum += partial.sum;
+                    group.rows += partial.rows;
+                }
+            }
+            std::vector<Group>().swap(local.spilled[p]);
+        }
+
+        std::vector<Group> groups;
+        groups.reserve(distinct);
+        for (const Group &group : table) {
+            if (group.rows != 0)
+                groups.push_back(group);
+        }
+        return groups;
+    }
+
+    ThreadPool &pool;
+    std::vector<Local> locals;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Runtime join filter over int keys: a cheap, cache-resident membership test that a scan
+// consults before probing the real join structure. Keys are never missed; other keys pass
+// only as false positives.
+// Dense key sets become an exact bitmap over [min key, max key]. Otherwise the filter is a
+// split-block Bloom filter: each key sets one bit in each of the eight 32-bit words of one
+// 256-bit block, so a probe touches a single cache line and is checked with one AVX2
+// compare when the CPU supports it (scalar otherwise, selected at runtime).
+// probeBatch also counts probed and passed rows; the counters are atomic and updated once
+// per batch, so concurrent scan tasks can share one filter.
+class JoinFilter {
+public:
+    enum class Kind {
+        Bitmap,
+        Bloom
+    };
+
+    struct alignas(32) Block {
+        uint32_t words[8];
+    };
+
+    // A bitmap is used when the key range needs at most MaxBitmapBitsPerKey bits per key,
+    // i.e. when it is at most 16x the size of the Bloom filter. It is exact and a probe is a
+    // single bit test, which beats the Bloom probe as long as the bitmap stays cache resident.
+    static constexpr uint64_t MaxBitmapBitsPerKey = 256;
+    // Bloom filter size; 16 bits per key gives a false-positive rate of roughly 0.1-0.2%.
+    static constexpr uint64_t BloomBitsPerKey = 16;
+
+    JoinFilter() = default;
+    JoinFilter(JoinFilter &&other) noexcept { *this = std::move(other); }
+    JoinFilter &operator=(JoinFilter &&other) noexcept;
+
+    void build(const int *keys, size_t count);
+
+    bool mayContain(int key) const;
+
+    // Writes to out the positions that may be in the filter and returns how many there are.
+    // Positions are sel[0..n) if sel is given, otherwise 0..n-1; keys is indexed by position.
+    // out may alias sel.
+    size_t probeBatch(const int *keys, const uint32_t *sel, size_t n, uint32_t *out) const;
+
+    Kind kind() const { return filterKind; }
+    const char *kindName() const { return filterKind == Kind::Bitmap ? "bitmap" : "bloom"; }
+    size_t sizeBytes() const { return bits.size() * sizeof(uint64_t) + blocks.size() * sizeof(Block); }
+
+    uint64_t probed() const { return probedRows.load(std::memory_order_relaxed); }
+    uint64_t eliminated() const { return probed() - passedRows.load(std::memory_order_relaxed); }
+    void resetCounters();
+
+private:
+    Kind filterKind = Kind::Bitmap;
+    int minKey = 0;
+    uint64_t range = 0;
+    std::vector<uint64_t> bits;  // Bitmap
+    std::vector<Block> blocks;   // Bloom
+    mutable std::atomic<uint64_t> probedRows{0};
+    mutable std::atomic<uint64_t> passedRows{0};
+};
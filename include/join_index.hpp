@@ -0,0 +1,135 @@
+#pragma once
+
+#include "morsel_dispatcher.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Maps int join keys to small values (row positions, nation slots, ...).
+// TPC-H keys are dense (custkey, suppkey 1..N) or sparse but bounded (orderkey), so when the
+// key range fits the slot budget the map is a direct-addressed array: a lookup is one bounds
+// check and one load. Otherwise it falls back to a hash map.
+// The largest Value is reserved as NotFound. If a key occurs more than once, the last entry wins
+// (unless the build is split across a pool, see build).
+template <typename Value>
+class KeyMap {
+public:
+    static constexpr Value NotFound = std::numeric_limits<Value>::max();
+    static constexpr uint64_t MaxSlotsPerKey = 8;
+
+    // Maps keyOf(i) -> valueOf(i) for i in 0..count-1. The array layout is used when the key
+    // range is at most slotBudget slots (default MaxSlotsPerKey * count).
+    // Given a pool, the min/max pass and the array fill of large inputs are split into morsels
+    // on it (call from outside the pool). Slots are then written with relaxed atomic stores, so
+    // workers filling the same slot for a duplicate key do not race; the key keeps one of its
+    // entries, which one is unspecified. The hash map layout is always built on the calling thread.
+    template <typename KeyFn, typename ValueFn>
+    void build(size_t count, KeyFn keyOf, ValueFn valueOf, uint64_t slotBudget = 0, ThreadPool *pool = nullptr) {
+        slots.clear();
+        map.clear();
+        dense = true;
+        minKey = 0;
+        if (count == 0)
+            return;
+
+        const bool parallel = pool != nullptr && pool->size() > 1 && count >= 2 * MorselDispatcher::DefaultMorselRows;
+        int lo = keyOf(0);
+        int hi = lo;
+        auto bound = [&keyOf](size_t begin, size_t end, int &lo, int &hi) {
+            for (size_t i = begin; i < end; i++) {
+                int key = keyOf(i);
+                lo = key < lo ? key : lo;
+                hi = key > hi ? key : hi;
+            }
+        };
+        if (parallel) {
+            std::vector<std::pair<int, int>> bounds(pool->size(), {lo, hi});
+            morselFor(*pool, count, MorselDispatcher::DefaultMorselRows, [&](size_t worker, size_t begin, size_t end) {
+                bound(begin, end, bounds[worker].first, bounds[worker].second);
+            });
+            for (const auto &b : bounds) {
+                lo = b.first < lo ? b.first : lo;
+                hi = b.second > hi ? b.second : hi;
+            }
+        } else {
+            bound(1, count, lo, hi);
+        }
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+        dense = range <= (slotBudget != 0 ? slotBudget : MaxSlotsPerKey * count);
+        if (dense) {
+            minKey = lo;
+            slots.assign(range, NotFound);
+            auto slotOf = [&](size_t i) -> Value & {
+                return slots[static_cast<uint64_t>(static_cast<int64_t>(keyOf(i)) - lo)];
+            };
+            if (parallel) {
+                // A relaxed store is a plain store on x86; it only makes concurrent writes to the
+                // same slot well defined. morselFor's wait publishes the slots to the caller.
+                morselFor(*pool, count, MorselDispatcher::DefaultMorselRows, [&](size_t, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++)
+                        __atomic_store_n(&slotOf(i), valueOf(i), __ATOMIC_RELAXED);
+                });
+            } else {
+                for (size_t i = 0; i < count; i++)
+                    slotOf(i) = valueOf(i);
+            }
+        } else {
+            map.reserve(count);
+            for (size_t i = 0; i < count; i++)
+                map[keyOf(i)] = valueOf(i);
+        }
+    }
+
+    // Value stored for key, or NotFound.
+    Value find(int key) const {
+        if (dense) {
+            uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(key) - minKey);
+            return offset < slots.size() ? slots[offset] : NotFound;
+        }
+        auto it = map.find(key);
+        return it == map.end() ? NotFound : it->second;
+    }
+
+    // Hints the cache line find(key) will read. Batched probes prefetch a group of keys before
+    // resolving them so the cache misses overlap. A no-op for the hash map layout.
+    void prefetch(int key) const {
+        if (dense) {
+            uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(key) - minKey);
+            if (offset < slots.size())
+                __builtin_prefetch(slots.data() + offset);
+        }
+    }
+
+    bool isDense() const { return dense; }
+
+private:
+    bool dense = true;
+    int minKey = 0;
+    std::vector<Value> slots;
+    std::unordered_map<int, Value> map;
+};
+
+// Maps join keys to row positions in a table.
+class JoinIndex : public KeyMap<uint32_t> {
+public:
+    // Indexes rows 0..count-1 of a table; keyOf(i) returns the key of row i. See KeyMap::build
+    // for pool.
+    template <typename KeyFn>
+    void build(size_t count, KeyFn keyOf, ThreadPool *pool = nullptr) {
+        KeyMap<uint32_t>::build(count, keyOf, [](size_t i) { return static_cast<uint32_t>(i); }, 0, pool);
+    }
+};
+
+// Join indexes over the loaded tables, one per primary key. DataManager builds them once
+// after loading and they are read-only afterwards, so every query shares them.
+struct JoinCatalog {
+    JoinIndex orders;    // o_orderkey -> row in DataManager::orders
+    JoinIndex customers; // c_custkey  -> row in DataManager::customers
+    JoinIndex suppliers; // s_suppkey  -> row in DataManager::suppliers
+    JoinIndex nations;   // n_nationkey -> row in DataManager::nations
+    JoinIndex regions;   // r_regionkey -> row in DataManager::regions
+};
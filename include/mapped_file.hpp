@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+// The mapping is released when the object is destroyed; the class is movable but not copyable.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // How the mapping will be read, passed to the kernel as a readahead hint. Table files are
+    // parsed front to back (Sequential); a snapshot's columns are also read at random, e.g. by
+    // join index probes and dictionary lookups (Normal).
+    enum class Access {
+        Sequential,
+        Normal
+    };
+
+    // Maps filePath into memory with the given access hint.
+    // Returns false if the file cannot be opened or mapped.
+    bool open(const std::string &filePath, Access access = Access::Sequential);
+    void close();
+
+    // Drops the pages that lie wholly inside [first, last) from the process, for a range that
+    // has been read and will not be read again. The mapping stays valid: a later read of the
+    // range faults the pages back in from the file.
+    void release(const char *first, const char *last) const;
+
+    bool isOpen() const { return fd >= 0; }
+    const char *data() const { return base; }
+    size_t size() const { return length; }
+    const char *begin() const { return base; }
+    const char *end() const { return base + length; }
+
+private:
+    int fd = -1;
+    const char *base = nullptr;
+    size_t length = 0;
+};
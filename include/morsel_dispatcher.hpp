@@ -0,0 +1,61 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Hands out consecutive row ranges ("morsels") of [0, rows) through one shared atomic cursor.
+// Workers pull the next morsel whenever they finish one, so a worker slowed down by skew, a
+// busy hyperthread sibling or background load simply takes fewer morsels instead of stalling
+// the whole operation on its fixed share.
+class MorselDispatcher {
+public:
+    // 64K rows: a few hundred KB per scanned column, and a whole number of the scan's batches.
+    static constexpr size_t DefaultMorselRows = 65536;
+
+    struct Morsel {
+        size_t begin;
+        size_t end;
+    };
+
+    MorselDispatcher(size_t rows, size_t morselRows = DefaultMorselRows)
+        : rows(rows), morselRows(std::max<size_t>(1, morselRows)) {}
+
+    // Claims the next morsel; false once every row has been handed out.
+    bool next(Morsel &morsel) {
+        size_t begin = cursor.fetch_add(morselRows, std::memory_order_relaxed);
+        if (begin >= rows)
+            return false;
+        morsel = Morsel{begin, std::min(rows, begin + morselRows)};
+        return true;
+    }
+
+    size_t morselCount() const { return (rows + morselRows - 1) / morselRows; }
+
+private:
+    const size_t rows;
+    const size_t morselRows;
+    alignas(64) std::atomic<size_t> cursor{0};
+};
+
+// Runs fn(worker, begin, end) for every morsel of [0, rows) on pool. One task per pool worker
+// (at most one per morsel) pulls morsels from a shared dispatcher until none are left; worker
+// is that task's index, so fn can keep per-worker state without locking.
+// Returns how many morsels each worker processed. Waits for its tasks, so it must be called
+// from outside the pool.
+template <typename Fn>
+std::vector<size_t> morselFor(ThreadPool &pool, size_t rows, size_t morselRows, Fn fn) {
+    MorselDispatcher dispatcher(rows, morselRows);
+    size_t workers = std::max<size_t>(1, std::min(pool.size(), dispatcher.morselCount()));
+    std::vector<size_t> morsels(workers, 0);
+    pool.parallelFor(workers, [&](size_t w) {
+        MorselDispatcher::Morsel morsel;
+        while (dispatcher.next(morsel)) {
+            fn(w, morsel.begin, morsel.end);
+            morsels[w]++;
+        }
+    });
+    return morsels;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "columnar_table.hpp"
+#include "decimal.hpp"
+#include "q5_plan.hpp"
+#include "small_group_by.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// The lineitem columns Q5 reads, for one batch of rows [first, first + rows). The join keys
+// are arrays of the batch's rows; price and discount are read from their columns only for the
+// rows that survive the joins, so encoded columns are decoded for those rows alone.
+struct LineitemBatch {
+    const int *orderkey;
+    const int *suppkey;
+    const Column<Money> *extendedprice;
+    const Column<Money> *discount;
+    size_t first;
+    size_t rows;
+};
+
+// Batch-at-a-time Q5 pipeline over lineitem. Each stage narrows a selection vector of row
+// positions within the batch and hands the survivors to the next stage:
+//   join filters -> probe orders -> probe suppliers (same nation) -> revenue -> aggregate.
+// Probes write their results into flat scratch arrays and compact the selection branch-free,
+// and revenue is computed exactly in fixed point over contiguous gathered arrays, so the
+// compiler vectorizes it as integer arithmetic.
+// With prefetching on, each probe stage walks its selection in groups of PrefetchGroup rows
+// and prefetches the map slots of the next group before resolving the current one, so the
+// slots are (mostly) in cache by the time they are read.
+// One instance per task; it is not thread-safe.
+class Q5Pipeline {
+public:
+    static constexpr size_t BatchRows = 1024;
+    static constexpr size_t PrefetchGroup = 16;
+
+    using Revenue = SmallGroupBy<Decimal<4>>;
+
+    // Revenue is added to groups, indexed by the nation's row in DataManager::nations
+    // (normally a task's row of a Revenue group-by).
+    Q5Pipeline(const Q5Plan &plan, Revenue::Slot *groups, bool prefetch);
+
+    // Runs one batch (batch.rows <= BatchRows) through the pipeline.
+    void consume(const LineitemBatch &batch);
+
+private:
+    const Q5Plan &plan;
+    Revenue::Slot *groups;
+    const bool prefetch;
+    uint32_t sel[BatchRows];
+    uint8_t nation[BatchRows];
+    Money price[BatchRows];
+    Money discount[BatchRows];
+    Decimal<4> amount[BatchRows];
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "data_manager.hpp"
+#include "join_filter.hpp"
+#include "join_index.hpp"
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Semi-join reduction for Q5, computed before lineitem is scanned.
+// Orders are reduced to those in [startDay, endDay) whose customer's nation lies in the
+// region, and suppliers to those whose nation lies in the region. Both map their key to the
+// nation's row in DataManager::nations, so a lineitem row qualifies iff its order and its
+// supplier are both present and map to the same nation (c_nationkey = s_nationkey).
+// The join filters let the scan discard most lineitem rows in batches before any map probe.
+struct Q5Plan {
+    std::vector<int> orderKeys;        // qualifying o_orderkey values
+    std::vector<uint8_t> orderNations; // customer nation row of orderKeys[i]
+    KeyMap<uint8_t> orderNation;       // o_orderkey -> customer nation row
+    KeyMap<uint8_t> supplierNation;    // s_suppkey  -> supplier nation row
+    JoinFilter orderFilter;            // runtime filters over the same key sets, checked by
+    JoinFilter supplierFilter;         // the lineitem scan before probing the maps above
+    size_t qualifyingSuppliers = 0;
+    int minOrderKey = INT_MAX;         // range of orderKeys and of the qualifying s_suppkey
+    int maxOrderKey = INT_MIN;         // values (min > max when none qualify), checked by the
+    int minSuppKey = INT_MAX;          // lineitem scan against its zone maps
+    int maxSuppKey = INT_MIN;
+    size_t skippedOrdersBlocks = 0;    // orders blocks the o_orderdate zone map ruled out
+};
+
+// The columns Q5 reads from each table: o_orderkey, o_custkey, o_orderdate, c_custkey,
+// c_nationkey, l_orderkey, l_suppkey, l_extendedprice, l_discount, s_suppkey, s_nationkey.
+ColumnSelection q5Columns();
+
+// Builds the plan from the loaded tables and dm.indexes. The orders filter is split into
+// tasks on dm.pool, so this must be called from outside the pool.
+Q5Plan planQ5(DataManager &dm, const std::string &region, int32_t startDay, int32_t endDay);
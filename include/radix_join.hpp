@@ -0,0 +1,143 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Parallel radix-partitioned hash join on int keys.
+// Both inputs are scattered into 2^radixBits() partitions by the top bits of a multiplicative
+// hash (histogram pass, prefix sum, scatter pass, each split across the pool). Partitions are
+// sized so that one build partition's hash table stays cache resident, and matching partition
+// pairs are then built and probed independently on the pool.
+// Every method waits for the tasks it submits, so it must be called from outside the pool.
+class RadixJoin {
+public:
+    explicit RadixJoin(ThreadPool &pool) : pool(pool) {}
+
+    // Partitions the build side; build row i has key keys[i]. Duplicate keys are allowed.
+    void build(const int *keys, size_t count) {
+        bits = 0;
+        while (bits < MaxRadixBits && (count >> bits) > TargetPartitionRows)
+            bits++;
+        buildSide = partition(keys, count);
+    }
+
+    // Joins probe rows against the build side. For every probe row i and build row b with
+    // keys[i] equal to the build key of b, calls emit(task, i, b) from one of `tasks` pool
+    // tasks (task < tasks), so callers can keep one accumulator per task without locking.
+    template <typename Emit>
+    void probe(const int *keys, size_t count, size_t tasks, Emit emit) {
+        Partitioned probeSide = partition(keys, count);
+        tasks = std::max<size_t>(1, tasks);
+        size_t partitionCount = partitions();
+        runTasks(tasks, [&](size_t task) {
+            std::vector<Tuple> table;
+            for (size_t p = task; p < partitionCount; p += tasks) {
+                const Tuple *b = buildSide.tuples.data() + buildSide.offsets[p];
+                size_t buildCount = buildSide.offsets[p + 1] - buildSide.offsets[p];
+                size_t probeCount = probeSide.offsets[p + 1] - probeSide.offsets[p];
+                if (buildCount == 0 || probeCount == 0)
+                    continue;
+
+                size_t capacity = 16;
+                while (capacity < 2 * buildCount)
+                    capacity <<= 1;
+                const size_t mask = capacity - 1;
+                table.assign(capacity, Tuple{0, Empty});
+                for (size_t i = 0; i < buildCount; i++) {
+                    size_t slot = hash(b[i].key) & mask;
+                    while (table[slot].row != Empty)
+                        slot = (slot + 1) & mask;
+                    table[slot] = b[i];
+                }
+
+                const Tuple *q = probeSide.tuples.data() + probeSide.offsets[p];
+                for (size_t i = 0; i < probeCount; i++) {
+                    for (size_t slot = hash(q[i].key) & mask; table[slot].row != Empty; slot = (slot + 1) & mask) {
+                        if (table[slot].key == q[i].key)
+                            emit(task, q[i].row, table[slot].row);
+                    }
+                }
+            }
+        });
+    }
+
+    unsigned radixBits() const { return bits; }
+    size_t partitions() const { return size_t(1) << bits; }
+
+private:
+    struct Tuple {
+        int key;
+        uint32_t row;
+    };
+
+    // Tuples grouped by partition: partition p occupies tuples[offsets[p], offsets[p + 1]).
+    struct Partitioned {
+        std::vector<Tuple> tuples;
+        std::vector<size_t> offsets;
+    };
+
+    static constexpr uint32_t Empty = std::numeric_limits<uint32_t>::max();
+    // ~16K tuples per partition keeps a partition's table (2x slots, 8 bytes each) near 256 KB.
+    static constexpr size_t TargetPartitionRows = 16384;
+    static constexpr unsigned MaxRadixBits = 12;
+    static constexpr size_t MinRowsPerTask = 65536;
+
+    static uint32_t hash(int key) { return static_cast<uint32_t>(key) * 2654435761u; }
+    size_t partitionOf(int key) const { return bits == 0 ? 0 : hash(key) >> (32 - bits); }
+
+    template <typename Fn>
+    void runTasks(size_t tasks, Fn fn) {
+        pool.parallelFor(tasks, fn);
+    }
+
+    Partitioned partition(const int *keys, size_t count) {
+        const size_t partitionCount = partitions();
+        const size_t chunks = std::max<size_t>(1, std::min(pool.size() * 4, count / MinRowsPerTask));
+        const size_t chunkSize = (count + chunks - 1) / chunks;
+        auto chunkBegin = [&](size_t c) { return std::min(count, c * chunkSize); };
+
+        // Pass 1: per-chunk histograms.
+        std::vector<std::vector<size_t>> histograms(chunks, std::vector<size_t>(partitionCount, 0));
+        runTasks(chunks, [&](size_t c) {
+            std::vector<size_t> &histogram = histograms[c];
+            for (size_t i = chunkBegin(c), end = chunkBegin(c + 1); i < end; i++)
+                histogram[partitionOf(keys[i])]++;
+        });
+
+        // Prefix sum: partition offsets, then each chunk's first write position per partition.
+        Partitioned out;
+        out.offsets.assign(partitionCount + 1, 0);
+        for (size_t p = 0; p < partitionCount; p++) {
+            size_t total = 0;
+            for (size_t c = 0; c < chunks; c++)
+                total += histograms[c][p];
+            out.offsets[p + 1] = out.offsets[p] + total;
+        }
+        for (size_t p = 0; p < partitionCount; p++) {
+            size_t position = out.offsets[p];
+            for (size_t c = 0; c < chunks; c++) {
+                size_t n = histograms[c][p];
+                histograms[c][p] = position;
+                position += n;
+            }
+        }
+
+        // Pass 2: scatter.
+        out.tuples.resize(count);
+        runTasks(chunks, [&](size_t c) {
+            std::vector<size_t> &cursor = histograms[c];
+            Tuple *tuples = out.tuples.data();
+            for (size_t i = chunkBegin(c), end = chunkBegin(c + 1); i < end; i++)
+                tuples[cursor[partitionOf(keys[i])]++] = Tuple{keys[i], static_cast<uint32_t>(i)};
+        });
+        return out;
+    }
+
+    ThreadPool &pool;
+    unsigned bits = 0;
+    Partitioned buildSide;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Group-by over a small dense key domain [0, groups), e.g. nation rows.
+// Every task owns one row of accumulators indexed directly by the group key, so aggregating a
+// value is one add into an array, with no hashing and no locking. Task rows are separated by a
+// full cache line of padding so tasks updating neighbouring rows never share a line.
+// merge() sums the rows after the tasks are done; group keys are resolved to names or other
+// attributes only by the caller, when producing the result.
+template <typename Value>
+class SmallGroupBy {
+public:
+    struct Slot {
+        Value sum{};
+        uint64_t rows = 0;
+    };
+
+    SmallGroupBy(size_t groups, size_t tasks)
+        : groups(groups), tasks(tasks), stride(paddedRow(groups)), slots(stride * tasks) {}
+
+    size_t groupCount() const { return groups; }
+    size_t taskCount() const { return tasks; }
+
+    // Accumulator row of task; only that task may update it.
+    Slot *local(size_t task) { return slots.data() + task * stride; }
+
+    void add(size_t task, size_t group, Value value) {
+        Slot &slot = local(task)[group];
+        slot.sum += value;
+        slot.rows++;
+    }
+
+    // Per-group totals over all tasks, in task order. Groups with rows == 0 saw no input.
+    std::vector<Slot> merge() const {
+        std::vector<Slot> total(groups);
+        for (size_t t = 0; t < tasks; t++) {
+            const Slot *row = slots.data() + t * stride;
+            for (size_t g = 0; g < groups; g++) {
+                total[g].sum += row[g].sum;
+                total[g].rows += row[g].rows;
+            }
+        }
+        return total;
+    }
+
+private:
+    static constexpr size_t CacheLineBytes = 64;
+
+    // Row length in slots: groups rounded up to whole cache lines, plus one line of padding.
+    static size_t paddedRow(size_t groups) {
+        size_t perLine = CacheLineBytes / sizeof(Slot) > 0 ? CacheLineBytes / sizeof(Slot) : 1;
+        return (groups + perLine - 1) / perLine * perLine + perLine;
+    }
+
+    size_t groups;
+    size_t tasks;
+    size_t stride;
+    std::vector<Slot> slots;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "columnar_table.hpp"
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Binary columnar snapshot: one file holding named columns of fixed-size values, written after
+// a text load and memory mapped on later starts, so loading is a page-in instead of a parse.
+//
+// Layout (integers in host byte order; a snapshot is only read on the machine type that wrote it):
+//   SnapshotHeader                       magic, format version, column count, fingerprint of
+//                                        the source files, checksum of the directory
+//   SnapshotColumn[columnCount]          the column directory
+//   column data                          each column starts on a 64-byte boundary
+// Encoded columns (see ColumnEncoding) are stored as their packed codes, with the encoding,
+// bit width and reference in the directory entry; a Dictionary column's dictionary is stored
+// as a plain column named "<column>.dict". Every column carries a checksum of its bytes.
+// Opening checks the header and the directory; SnapshotReader::verify then checks the column
+// checksums (DataManager does so on the pool unless LoadOptions::verifySnapshot is off). A
+// snapshot whose magic, version, fingerprint or any checksum checked does not match is
+// rejected whole. Dictionary codes are bounds-checked when a column is handed out, so even an
+// unverified snapshot cannot make a lookup read past its dictionary.
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columnCount;
+    uint64_t fingerprint;
+    uint64_t directoryChecksum;
+};
+
+struct SnapshotColumn {
+    char name[48];       // NUL-terminated, e.g. "lineitem.l_orderkey"
+    uint32_t elementSize;
+    uint8_t encoding;    // ColumnEncoding
+    uint8_t bits;        // packed code width of an encoded column
+    uint16_t reserved;
+    uint64_t rows;
+    int64_t reference;   // FrameOfReference base value
+    uint64_t offset;     // from the start of the file
+    uint64_t bytes;      // rows * elementSize, or packedWordCount(rows, bits) * 4 if encoded
+    uint64_t checksum;   // snapshotChecksum of the column bytes
+};
+
+static_assert(sizeof(SnapshotHeader) == 32 && sizeof(SnapshotColumn) == 96, "snapshot layout is fixed");
+
+constexpr char SnapshotMagic[8] = {'Z', 'B', 'S', 'N', 'A', 'P', 'S', 'H'};
+constexpr uint32_t SnapshotVersion = 2;
+
+// Fast 64-bit checksum (four independent multiply-xor lanes over 8-byte words).
+uint64_t snapshotChecksum(const void *data, size_t bytes);
+
+// Collects columns and writes them as one snapshot file. The columns are not copied, so
+// they must stay alive until write() returns.
+class SnapshotWriter {
+public:
+    void add(const std::string &name, const void *data, uint64_t rows, uint32_t elementSize);
+
+    template <typename T>
+    void add(const std::string &name, const Column<T> &column) {
+        if (!column.isEncoded()) {
+            add(name, column.data(), column.size(), sizeof(T));
+            return;
+        }
+        addEncoded(name, column.packedWords(), column.size(), sizeof(T), column.encoding(), column.packedBits(),
+                   column.reference());
+        if (column.encoding() == ColumnEncoding::Dictionary)
+            add(name + ".dict", column.dictionary(), column.dictionarySize(), sizeof(T));
+    }
+
+    // Writes to path + ".tmp" and renames it over path, so readers never see a partial file.
+    // Returns false and sets error on failure.
+    bool write(const std::string &path, uint64_t fingerprint, std::string &error) const;
+
+private:
+    void addEncoded(const std::string &name, const uint32_t *packed, uint64_t rows, uint32_t elementSize,
+                    ColumnEncoding encoding, unsigned bits, int64_t reference);
+
+    struct Pending {
+        std::string name;
+        const void *data;
+        uint64_t rows;
+        uint32_t elementSize;
+        ColumnEncoding encoding;
+        unsigned bits;
+        int64_t reference;
+    };
+    std::vector<Pending> columns;
+};
+
+// Maps a snapshot file and validates it. Columns are handed out as views that share the
+// mapping, which stays open until the reader and every such column are gone.
+class SnapshotReader {
+public:
+    // Returns false and sets error if the file is missing, malformed, written by another
+    // format version or taken from other source files (fingerprint). Only the header and the
+    // directory are read; the column data is not touched.
+    bool open(const std::string &path, uint64_t fingerprint, std::string &error);
+
+    // Checks every column against its checksum, which reads the whole file; with a pool the
+    // columns are checked concurrently (call from outside the pool). Returns false and sets
+    // error if a column does not match.
+    bool verify(std::string &error, ThreadPool *pool = nullptr) const;
+
+    // Column name as a view, or false if it is absent, has another element size, is encoded
+    // in a way T does not support or holds a dictionary code past the end of its dictionary.
+    template <typename T>
+    bool column(const std::string &name, Column<T> &out) const {
+        const SnapshotColumn *entry = find(name);
+        if (entry == nullptr || entry->elementSize != sizeof(T))
+            return false;
+        ColumnEncoding encoding = static_cast<ColumnEncoding>(entry->encoding);
+        if (encoding == ColumnEncoding::Plain) {
+            out = Column<T>::view(reinterpret_cast<const T *>(file->data() + entry->offset), entry->rows, file);
+            return true;
+        }
+        if (!ColumnCodec<T>::Encodable)
+            return false;
+        const uint32_t *packed = reinterpret_cast<const uint32_t *>(file->data() + entry->offset);
+        Column<T> dictionary;
+        if (encoding == ColumnEncoding::Dictionary) {
+            if (!column(name + ".dict", dictionary) || dictionary.isEncoded() || dictionary.empty() ||
+                bitWidth(dictionary.size() - 1) != entry->bits || !codesBelow(*entry, dictionary.size()))
+                return false;
+        }
+        out = Column<T>::encodedView(encoding, entry->bits, entry->reference, entry->rows, packed, dictionary.data(),
+                                     dictionary.size(), file);
+        return true;
+    }
+
+    const SnapshotColumn *find(const std::string &name) const;
+
+private:
+    // True if every packed code of entry is below limit.
+    bool codesBelow(const SnapshotColumn &entry, size_t limit) const;
+
+    std::shared_ptr<MappedFile> file;
+    std::vector<const SnapshotColumn *> directory;
+};
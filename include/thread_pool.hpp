@@ -1,14 +1,109 @@
 #pragma once
 
 #include <vector>
-#include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+// Type-erased void() callable the pool runs. Callables of up to InlineBytes are stored inside
+// the object, so building a task does not allocate; larger ones go to the heap. A PoolTask
+// cannot be moved (the pool holds pointers to it), so submitters keep task arrays in place
+// until the tasks have run.
+class PoolTask {
+public:
+    static constexpr size_t InlineBytes = 48;
+
+    PoolTask() = default;
+    PoolTask(const PoolTask &) = delete;
+    PoolTask &operator=(const PoolTask &) = delete;
+    ~PoolTask() { reset(); }
+
+    template <class F>
+    void emplace(F &&f) {
+        using Fn = std::decay_t<F>;
+        reset();
+        if constexpr (sizeof(Fn) <= InlineBytes && alignof(Fn) <= alignof(std::max_align_t)) {
+            target = new (storage) Fn(std::forward<F>(f));
+            destroy = [](void *p) { static_cast<Fn *>(p)->~Fn(); };
+        } else {
+            target = new Fn(std::forward<F>(f));
+            destroy = [](void *p) { delete static_cast<Fn *>(p); };
+        }
+        invoke = [](void *p) { (*static_cast<Fn *>(p))(); };
+    }
+
+    void operator()() { invoke(target); }
+
+    void reset() {
+        if (destroy)
+            destroy(target);
+        target = nullptr;
+        invoke = nullptr;
+        destroy = nullptr;
+    }
+
+private:
+    friend class ThreadPool;
+
+    alignas(std::max_align_t) unsigned char storage[InlineBytes];
+    void *target = nullptr;
+    void (*invoke)(void *) = nullptr;
+    void (*destroy)(void *) = nullptr;
+    bool ownedByPool = false; // allocated by enqueue(); the worker deletes it after running it
+};
+
+// Counts outstanding tasks; wait() blocks until done() has been called once per add()ed task.
+// done() and wait() both take the lock, so the waiter may destroy the WaitGroup as soon as
+// wait() returns.
+class WaitGroup {
+public:
+    void add(size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        count += n;
+    }
+
+    void done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--count == 0)
+            zero.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        zero.wait(lock, [this] { return count == 0; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable zero;
+    size_t count = 0;
+};
+
+// Work-stealing thread pool.
+// Every worker owns a Chase-Lev deque: the worker pushes and pops tasks at the bottom, idle
+// workers steal from the top of a randomly chosen victim. Tasks enqueued from outside the pool
+// go to a shared injection queue; a worker taking from it also moves a share of the queued
+// tasks into its own deque, where the other workers can steal them, so bulk submissions spread
+// out without every task passing through the shared lock. Tasks enqueued from a worker go
+// straight to that worker's deque.
+// Besides enqueue(), which returns a future, submit() hands over caller-owned PoolTasks in
+// bulk and parallelFor() runs a loop on the pool without futures or per-task allocations.
+// Tasks run in no particular order. Never wait (on a future, a WaitGroup or parallelFor) from
+// inside a pool task: the waiting worker does not run other tasks meanwhile, so the pool can
+// deadlock.
 class ThreadPool {
 public:
     explicit ThreadPool(size_t threads);
@@ -17,37 +112,122 @@ public:
     template <class F, class... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+    // Queues tasks[0..n) with a single lock acquisition (or none, from a worker). The pool
+    // does not take ownership: the tasks must stay alive until they have run.
+    void submit(PoolTask *tasks, size_t n = 1);
+
+    // Runs fn(i) for every i in [0, count) and waits for all of them. At most size() tasks are
+    // submitted, each claiming indices from a shared counter. The first exception thrown by fn
+    // is rethrown here once every task has finished.
+    template <class Fn>
+    void parallelFor(size_t count, Fn fn);
+
+    // Number of worker threads.
+    size_t size() const { return workers.size(); }
+
 private:
+    using Task = PoolTask;
+
+    // Fixed-capacity Chase-Lev deque of task pointers (Le et al., "Correct and Efficient
+    // Work-Stealing for Weak Memory Models", 2013). push and pop are owner-only; steal may be
+    // called by any thread. A full deque rejects the push and the task goes to the injection queue.
+    class WorkDeque {
+    public:
+        static constexpr int64_t Capacity = 4096;
+
+        bool push(Task *task) {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            if (b - t >= Capacity)
+                return false;
+            buffer[b & (Capacity - 1)].store(task, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        Task *pop() {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            Task *task = buffer[b & (Capacity - 1)].load(std::memory_order_relaxed);
+            if (t == b) {
+                // Last task: race the thieves for it.
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    task = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+
+        Task *steal() {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+            Task *task = buffer[t & (Capacity - 1)].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return task;
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Task *> buffer[Capacity];
+    };
+
+    struct alignas(64) Worker {
+        WorkDeque deque;
+        uint64_t rng;
+    };
+
+    // The pool and worker index of the calling thread, if it is a pool worker.
+    struct CurrentWorker {
+        const ThreadPool *pool = nullptr;
+        size_t index = 0;
+    };
+    static CurrentWorker &currentWorker() {
+        static thread_local CurrentWorker current;
+        return current;
+    }
+
+    Task *findTask(size_t self);
+    Task *takeInjected(size_t self);
+    Task *stealFrom(size_t self);
+    void wakeOne();
+    void workerLoop(size_t self);
+
     // Worker threads
     std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Worker>> workerState;
 
-    // Task queue
-    std::queue<std::function<void()>> tasks;
+    // Injection queue for tasks enqueued from outside the pool
+    std::deque<Task *> injected;
 
-    // Synchronization
+    // Synchronization. pending counts tasks submitted but not yet picked up for running;
+    // sleeping counts workers blocked on condition.
     std::mutex queueMutex;
     std::condition_variable condition;
-    bool stop = false;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> sleeping{0};
+    std::atomic<bool> stop{false};
 };
 
 // Constructor
 inline ThreadPool::ThreadPool(size_t threads) {
     for (size_t i = 0; i < threads; ++i) {
-        workers.emplace_back([this] {
-            for (;;) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(this->queueMutex);
-                    this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
-                    if (this->stop && this->tasks.empty())
-                        return;
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
-                }
-                task();
-            }
-        });
+        workerState.push_back(std::make_unique<Worker>());
+        workerState.back()->rng = 0x9E3779B97F4A7C15ull * (i + 1);
     }
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back([this, i] { workerLoop(i); });
 }
 
 // Destructor
@@ -66,17 +246,162 @@ template <class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type> {
     using return_type = typename std::invoke_result<F, Args...>::type;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::packaged_task<return_type()> task(
         std::bind(std::forward<F>(f), std::forward<Args>(args)...)
     );
 
-    std::future<return_type> res = task->get_future();
+    std::future<return_type> res = task.get_future();
+    if (stop)
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+    Task *owned = new Task();
+    owned->emplace(std::move(task));
+    owned->ownedByPool = true;
+    submit(owned);
+    return res;
+}
+
+inline void ThreadPool::submit(Task *tasks, size_t n) {
+    if (n == 0)
+        return;
+    // Count the tasks before they become visible, so pending never drops below the tasks queued.
+    pending.fetch_add(n);
+    CurrentWorker &current = currentWorker();
+    size_t queued = 0;
+    if (current.pool == this) {
+        while (queued < n && workerState[current.index]->deque.push(&tasks[queued]))
+            queued++;
+    }
+    if (queued < n) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (; queued < n; queued++)
+            injected.push_back(&tasks[queued]);
+    }
+    if (n == 1) {
+        wakeOne();
+    } else if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        condition.notify_all();
+    }
+}
+
+template <class Fn>
+void ThreadPool::parallelFor(size_t count, Fn fn) {
+    if (count == 0)
+        return;
+    size_t taskCount = std::max<size_t>(1, std::min(count, size()));
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    WaitGroup group;
+    group.add(taskCount);
+
+    std::unique_ptr<Task[]> tasks(new Task[taskCount]);
+    for (size_t t = 0; t < taskCount; t++) {
+        tasks[t].emplace([&]() {
+            try {
+                for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                    fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+                next.store(count);
+            }
+            group.done();
+        });
+    }
+    submit(tasks.get(), taskCount);
+    group.wait();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+inline void ThreadPool::wakeOne() {
+    // A worker going to sleep registers in sleeping before it re-checks pending under the
+    // lock, so either it sees the new task or this sees it and notifies under the lock.
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        condition.notify_one();
+    }
+}
+
+inline ThreadPool::Task *ThreadPool::findTask(size_t self) {
+    if (Task *task = workerState[self]->deque.pop())
+        return task;
+    if (Task *task = takeInjected(self))
+        return task;
+    return stealFrom(self);
+}
+
+// Takes one injected task to run and moves up to a fair share of the rest into self's deque.
+inline ThreadPool::Task *ThreadPool::takeInjected(size_t self) {
+    Task *first = nullptr;
+    std::vector<Task *> batch;
     {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (injected.empty())
+            return nullptr;
+        first = injected.front();
+        injected.pop_front();
+        size_t share = std::min<size_t>(injected.size() / workers.size(), WorkDeque::Capacity / 2);
+        batch.assign(injected.begin(), injected.begin() + share);
+        injected.erase(injected.begin(), injected.begin() + share);
+    }
+    WorkDeque &deque = workerState[self]->deque;
+    // Push in reverse so the owner pops them in submission order.
+    for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+        if (!deque.push(*it)) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            injected.push_front(*it);
+        }
+    }
+    if (!batch.empty())
+        wakeOne();
+    return first;
+}
+
+// Tries every other worker once, starting at a random victim.
+inline ThreadPool::Task *ThreadPool::stealFrom(size_t self) {
+    size_t count = workerState.size();
+    if (count < 2)
+        return nullptr;
+    uint64_t &rng = workerState[self]->rng;
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    size_t start = rng % count;
+    for (size_t i = 0; i < count; i++) {
+        size_t victim = (start + i) % count;
+        if (victim == self)
+            continue;
+        if (Task *task = workerState[victim]->deque.steal())
+            return task;
+    }
+    return nullptr;
+}
+
+inline void ThreadPool::workerLoop(size_t self) {
+    currentWorker() = CurrentWorker{this, self};
+    for (;;) {
+        if (Task *task = findTask(self)) {
+            pending.fetch_sub(1);
+            // A caller-owned task may be destroyed as soon as it has run, so read this first.
+            bool owned = task->ownedByPool;
+            (*task)();
+            if (owned)
+                delete task;
+            continue;
+        }
+        if (pending.load() > 0) {
+            // A task is queued but was not visible yet or was taken by a thief; retry.
+            std::this_thread::yield();
+            continue;
+        }
         std::unique_lock<std::mutex> lock(queueMutex);
-        if (stop)
-            throw std::runtime_error("enqueue on stopped ThreadPool");
-        tasks.emplace([task]() { (*task)(); });
+        sleeping.fetch_add(1);
+        condition.wait(lock, [this] { return stop || pending.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stop && pending.load() == 0)
+            return;
     }
-    condition.notify_one();
-    return res;
-}
\ No newline at end of file
+}
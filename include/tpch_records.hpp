@@ -0,0 +1,55 @@
+#pragma once
+
+#include "decimal.hpp"
+#include <cstdint>
+#include <string>
+
+// Record structures for TPC-H tables.
+
+// Customer: c_custkey (index 0) and c_nationkey (index 3)
+struct Customer {
+    int custkey;
+    int nationkey;
+};
+
+// Orders: o_orderkey (index 0), o_custkey (index 1), o_orderdate (index 4)
+// orderdate is stored as days since 1970-01-01 (see parseDate), so date order is integer order.
+struct Orders {
+    int orderkey;
+    int custkey;
+    int32_t orderdate;
+};
+
+// Lineitem: l_orderkey (index 0), l_extendedprice (index 5), l_discount (index 6), l_suppkey (index 2),
+// and the optional l_quantity (4), l_tax (7), l_returnflag (8), l_linestatus (9), l_shipdate (10)
+// Money fields are exact fixed-point hundredths (see decimal.hpp); shipdate is in days like orderdate.
+struct Lineitem {
+    int orderkey;
+    Money extendedprice;
+    Money discount;
+    int suppkey;
+    Money quantity;
+    Money tax;
+    char returnflag;
+    char linestatus;
+    int32_t shipdate;
+};
+
+// Supplier: s_suppkey (index 0), s_nationkey (index 3)
+struct Supplier {
+    int suppkey;
+    int nationkey;
+};
+
+// Nation: n_nationkey (index 0), n_name (index 1), n_regionkey (index 2)
+struct Nation {
+    int nationkey;
+    std::string name;
+    int regionkey;
+};
+
+// Region: r_regionkey (index 0), r_name (index 1)
+struct Region {
+    int regionkey;
+    std::string name;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "columnar_table.hpp"
+#include "morsel_dispatcher.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Per-block minimum and maximum of one column (a zone map). A scan with a range predicate on
+// the column skips every block whose [min, max] cannot meet the range, without reading it.
+// Values are kept as int64 (ColumnCodec<T>::toInt, so Money as hundredths). Blocks are one
+// default morsel, so a morsel is either skipped whole or scanned.
+class ZoneMap {
+public:
+    static constexpr size_t BlockRows = MorselDispatcher::DefaultMorselRows;
+
+    // Computes the statistics of every block (Column::range, which compares the codes of an
+    // encoded column without decoding them).
+    template <typename T>
+    void build(const Column<T> &column) {
+        static_assert(ColumnCodec<T>::Encodable, "zone maps cover integer and decimal columns");
+        size_t rows = column.size();
+        size_t blocks = (rows + BlockRows - 1) / BlockRows;
+        minimum.resize(blocks);
+        maximum.resize(blocks);
+        for (size_t b = 0; b < blocks; b++) {
+            size_t first = b * BlockRows;
+            std::pair<T, T> range = column.range(first, std::min(rows, first + BlockRows) - first);
+            minimum[b] = ColumnCodec<T>::toInt(range.first);
+            maximum[b] = ColumnCodec<T>::toInt(range.second);
+        }
+        coveredRows = rows;
+    }
+
+    size_t blockCount() const { return minimum.size(); }
+    int64_t min(size_t block) const { return minimum[block]; }
+    int64_t max(size_t block) const { return maximum[block]; }
+
+    // False only if no row in [first, end) can hold a value in [lo, hi]. Rows the map does not
+    // cover (e.g. it was never built) may always match.
+    bool mayContain(size_t first, size_t end, int64_t lo, int64_t hi) const {
+        if (first >= end || lo > hi)
+            return false;
+        if (end > coveredRows)
+            return true;
+        for (size_t b = first / BlockRows; b <= (end - 1) / BlockRows; b++) {
+            if (minimum[b] <= hi && maximum[b] >= lo)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<int64_t> minimum;
+    std::vector<int64_t> maximum;
+    size_t coveredRows = 0;
+};
+
+// Zone maps over every numeric and date column of the scanned tables, built by
+// DataManager::loadAllTables. Maps of columns that were not loaded are empty.
+struct ZoneMapCatalog {
+    ZoneMap lineitemOrderkey;
+    ZoneMap lineitemExtendedprice;
+    ZoneMap lineitemDiscount;
+    ZoneMap lineitemSuppkey;
+    ZoneMap lineitemQuantity;
+    ZoneMap lineitemTax;
+    ZoneMap lineitemShipdate;
+    ZoneMap ordersOrderkey;
+    ZoneMap ordersCustkey;
+    ZoneMap ordersOrderdate;
+    ZoneMap customerCustkey;
+    ZoneMap customerNationkey;
+    ZoneMap supplierSuppkey;
+    ZoneMap supplierNationkey;
+};
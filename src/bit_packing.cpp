@@ -0,0 +1,101 @@
+#include "bit_packing.hpp"
+#include "cpu_dispatch.hpp"
+#include <cstring>
+
+void packBlock(const uint32_t *in, unsigned bits, uint32_t *out) {
+    if (bits == 0)
+        return; // no words to write
+    std::memset(out, 0, packedBlockWords(bits) * sizeof(uint32_t));
+    for (size_t k = 0; k < PackBlockValues / PackLanes; k++) {
+        size_t bit = k * bits;
+        size_t word = bit / 32;
+        unsigned offset = static_cast<unsigned>(bit % 32);
+        for (size_t lane = 0; lane < PackLanes; lane++) {
+            uint64_t value = in[k * PackLanes + lane];
+            out[word * PackLanes + lane] |= static_cast<uint32_t>(value << offset);
+            if (offset + bits > 32)
+                out[(word + 1) * PackLanes + lane] |= static_cast<uint32_t>(value >> (32 - offset));
+        }
+    }
+}
+
+namespace {
+
+void unpackScalar(const uint32_t *packed, unsigned bits, size_t blocks, uint32_t *out) {
+    if (bits == 0) {
+        std::memset(out, 0, blocks * PackBlockValues * sizeof(uint32_t));
+        return;
+    }
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    for (size_t b = 0; b < blocks; b++, packed += packedBlockWords(bits), out += PackBlockValues) {
+        for (size_t k = 0; k < PackBlockValues / PackLanes; k++) {
+            size_t bit = k * bits;
+            size_t word = bit / 32;
+            unsigned offset = static_cast<unsigned>(bit % 32);
+            for (size_t lane = 0; lane < PackLanes; lane++) {
+                uint64_t value = packed[word * PackLanes + lane] >> offset;
+                if (offset + bits > 32)
+                    value |= static_cast<uint64_t>(packed[(word + 1) * PackLanes + lane]) << (32 - offset);
+                out[k * PackLanes + lane] = static_cast<uint32_t>(value & mask);
+            }
+        }
+    }
+}
+
+#ifdef CPU_DISPATCH_X86
+
+__attribute__((target("avx2")))
+void unpackAvx2(const uint32_t *packed, unsigned bits, size_t blocks, uint32_t *out) {
+    if (bits == 0) {
+        std::memset(out, 0, blocks * PackBlockValues * sizeof(uint32_t));
+        return;
+    }
+    const __m256i mask = _mm256_set1_epi32(bits == 32 ? -1 : static_cast<int>((1u << bits) - 1));
+    for (size_t b = 0; b < blocks; b++, packed += packedBlockWords(bits), out += PackBlockValues) {
+        const __m256i *words = reinterpret_cast<const __m256i *>(packed);
+        for (size_t k = 0; k < PackBlockValues / PackLanes; k++) {
+            size_t bit = k * bits;
+            size_t word = bit / 32;
+            unsigned offset = static_cast<unsigned>(bit % 32);
+            __m256i value = _mm256_srl_epi32(_mm256_loadu_si256(words + word), _mm_cvtsi32_si128(static_cast<int>(offset)));
+            if (offset + bits > 32) {
+                __m256i high = _mm256_loadu_si256(words + word + 1);
+                value = _mm256_or_si256(value, _mm256_sll_epi32(high, _mm_cvtsi32_si128(static_cast<int>(32 - offset))));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k * PackLanes), _mm256_and_si256(value, mask));
+        }
+    }
+}
+
+#endif
+
+const KernelChoice<UnpackKernel> &activeKernel() {
+    static const KernelChoice<UnpackKernel> choice = selectKernel<UnpackKernel>({
+#ifdef CPU_DISPATCH_X86
+        {CpuFeature::Avx2, unpackAvx2},
+#endif
+    }, unpackScalar);
+    return choice;
+}
+
+} // namespace
+
+UnpackKernel unpackKernel() {
+    return activeKernel().kernel;
+}
+
+const char *unpackKernelName() {
+    return activeKernel().name;
+}
+
+UnpackKernel scalarUnpackKernel() {
+    return unpackScalar;
+}
+
+UnpackKernel avx2UnpackKernel() {
+#ifdef CPU_DISPATCH_X86
+    if (cpuSupports(CpuFeature::Avx2))
+        return unpackAvx2;
+#endif
+    return nullptr;
+}
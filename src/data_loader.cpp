@@ -1,163 +1,435 @@
 #include "data_loader.hpp"
+#include "field_parsers.hpp"
+#include "field_tokenizer.hpp"
+#include "mapped_file.hpp"
+#include "morsel_dispatcher.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <iostream>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
 
-std::vector<std::string> DataLoader::splitLine(const std::string &line, char delimiter) {
-    std::vector<std::string> tokens;
-    std::istringstream stream(line);
-    std::string token;
-    while (std::getline(stream, token, delimiter)) {
-        tokens.push_back(token);
+namespace {
+
+// Turns raw fields into values with the fixed-format parsers. When validating, a malformed
+// field throws std::invalid_argument naming the column, which skips and reports the row.
+class FieldConverter {
+public:
+    explicit FieldConverter(bool validate) : validate(validate) {}
+
+    int32_t toInt(std::string_view field, const char *column) const {
+        if (!validate)
+            return parseInt32(field);
+        int32_t value;
+        if (!tryParseInt32(field, value))
+            malformed(field, column);
+        return value;
     }
-    return tokens;
-}
 
-std::vector<Customer> DataLoader::loadCustomerData(const std::string &filePath) {
-    std::vector<Customer> customers;
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        std::cerr << "Error opening customer file: " << filePath << "\n";
-        return customers;
+    // Two-decimal value in hundredths (money, discount).
+    int64_t toHundredths(std::string_view field, const char *column) const {
+        if (!validate)
+            return parseDecimal2(field);
+        int64_t value;
+        if (!tryParseDecimal2(field, value))
+            malformed(field, column);
+        return value;
     }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto tokens = splitLine(line);
-        if (tokens.size() < 4) continue;
-        try {
-            Customer c;
-            c.custkey = std::stoi(tokens[0]);
-            c.nationkey = std::stoi(tokens[3]);
-            customers.push_back(c);
-        } catch (const std::exception &e) {
-            std::cerr << "Parsing error in customer file: " << e.what() << "\n";
-        }
+
+    // parseDate reads ten characters unchecked, so a shorter field (e.g. a truncated last row)
+    // takes the checked path and is rejected even without validate.
+    int32_t toDate(std::string_view field, const char *column) const {
+        if (!validate && field.size() >= 10)
+            return parseDate(field);
+        int32_t value;
+        if (!tryParseDate(field, value))
+            malformed(field, column);
+        return value;
     }
-    return customers;
+
+    // One-character flag (l_returnflag, l_linestatus).
+    char toFlag(std::string_view field, const char *column) const {
+        if (validate && field.size() != 1)
+            malformed(field, column);
+        return field.empty() ? '\0' : field[0];
+    }
+
+private:
+    [[noreturn]] static void malformed(std::string_view field, const char *column) {
+        throw std::invalid_argument("malformed " + std::string(column) + " '" + std::string(field) + "'");
+    }
+
+    bool validate;
+};
+
+void reportRejected(const char *table, size_t rejected) {
+    if (rejected > 0)
+        std::cerr << "Skipped " << rejected << " malformed " << table << " rows.\n";
 }
 
-std::vector<Orders> DataLoader::loadOrdersData(const std::string &filePath) {
-    std::vector<Orders> orders;
+// Moves the rows of src to the end of dst. Row vectors move their elements; columnar tables
+// copy their column arrays.
+template <typename Row>
+void appendRows(std::vector<Row> &dst, std::vector<Row> &&src) {
+    dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+}
+
+template <typename Table>
+void appendRows(Table &dst, Table &&src) {
+    dst.append(src);
+}
+
+// Reads filePath line by line and appends every row that has all of the tokenizer's columns
+// to a Table (a std::vector of rows or a columnar table).
+// parseRow receives only the requested fields and may throw on malformed input.
+template <typename Table, size_t N, typename ParseFn>
+Table loadWithStream(const std::string &filePath, const Table &empty, const char *table,
+                     const FieldTokenizer<N> &tokenizer, ParseFn parseRow) {
+    Table rows = empty;
     std::ifstream file(filePath);
     if (!file.is_open()) {
-        std::cerr << "Error opening orders file: " << filePath << "\n";
-        return orders;
+        std::cerr << "Error opening " << table << " file: " << filePath << "\n";
+        return rows;
     }
+    std::array<std::string_view, N> fields;
     std::string line;
+    size_t rejected = 0;
     while (std::getline(file, line)) {
         if (line.empty()) continue;
-        auto tokens = splitLine(line);
-        if (tokens.size() < 5) continue;
+        if (!tokenizer.tokenize(line, fields)) continue;
         try {
-            Orders o;
-            o.orderkey = std::stoi(tokens[0]);
-            o.custkey = std::stoi(tokens[1]);
-            o.orderdate = tokens[4];
-            orders.push_back(o);
+            rows.push_back(parseRow(fields));
         } catch (const std::exception &e) {
-            std::cerr << "Parsing error in orders file: " << e.what() << "\n";
+            std::cerr << "Parsing error in " << table << " file: " << e.what() << "\n";
+            ++rejected;
         }
     }
-    return orders;
+    reportRejected(table, rejected);
+    return rows;
 }
 
-std::vector<Lineitem> DataLoader::loadLineitemData(const std::string &filePath) {
-    std::vector<Lineitem> lineitems;
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        std::cerr << "Error opening lineitem file: " << filePath << "\n";
-        return lineitems;
-    }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto tokens = splitLine(line);
-        if (tokens.size() < 7) continue;
+// Parses the rows in [begin, end), which must start at the beginning of a line, into rows.
+// Returns the number of rows rejected by parseRow.
+template <typename Table, size_t N, typename ParseFn>
+size_t parseRange(const char *begin, const char *end, const char *table,
+                  const FieldTokenizer<N> &tokenizer, ParseFn parseRow, Table &rows) {
+    size_t rejected = 0;
+    std::array<std::string_view, N> fields;
+    DelimiterCursor cursor(begin, end);
+    while (!cursor.atEnd()) {
+        if (!tokenizer.next(cursor, fields)) continue;
         try {
-            Lineitem l;
-            l.orderkey = std::stoi(tokens[0]);
-            l.suppkey = std::stoi(tokens[2]);
-            l.extendedprice = std::stod(tokens[5]);
-            l.discount = std::stod(tokens[6]);
-            lineitems.push_back(l);
+            rows.push_back(parseRow(fields));
         } catch (const std::exception &e) {
-            std::cerr << "Parsing error in lineitem file: " << e.what() << "\n";
+            std::cerr << "Parsing error in " << table << " file: " << e.what() << "\n";
+            ++rejected;
         }
     }
-    return lineitems;
+    return rejected;
 }
 
-std::vector<Supplier> DataLoader::loadSupplierData(const std::string &filePath) {
-    std::vector<Supplier> suppliers;
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        std::cerr << "Error opening supplier file: " << filePath << "\n";
-        return suppliers;
-    }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto tokens = splitLine(line);
-        if (tokens.size() < 4) continue;
+// Like parseRange, but rows holds at most batchRows rows: whenever it fills up, and once more
+// at the end of the range, it is passed to flush and cleared.
+template <typename Table, size_t N, typename ParseFn, typename FlushFn>
+size_t parseBatches(const char *begin, const char *end, const char *table, const FieldTokenizer<N> &tokenizer,
+                    ParseFn parseRow, Table &rows, size_t batchRows, FlushFn flush) {
+    size_t rejected = 0;
+    std::array<std::string_view, N> fields;
+    DelimiterCursor cursor(begin, end);
+    while (!cursor.atEnd()) {
+        if (!tokenizer.next(cursor, fields)) continue;
         try {
-            Supplier s;
-            s.suppkey = std::stoi(tokens[0]);
-            s.nationkey = std::stoi(tokens[3]);
-            suppliers.push_back(s);
+            rows.push_back(parseRow(fields));
         } catch (const std::exception &e) {
-            std::cerr << "Parsing error in supplier file: " << e.what() << "\n";
+            std::cerr << "Parsing error in " << table << " file: " << e.what() << "\n";
+            ++rejected;
+            continue;
+        }
+        if (rows.size() == batchRows) {
+            flush(rows);
+            rows.clear();
         }
     }
-    return suppliers;
+    if (!rows.empty()) {
+        flush(rows);
+        rows.clear();
+    }
+    return rejected;
 }
 
-std::vector<Nation> DataLoader::loadNationData(const std::string &filePath) {
-    std::vector<Nation> nations;
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        std::cerr << "Error opening nation file: " << filePath << "\n";
-        return nations;
+// Smallest byte range worth handing to a separate worker.
+constexpr size_t MinChunkBytes = 8u << 20;
+// Chunks per worker, so a slow chunk does not leave the other workers idle at the end.
+constexpr size_t ChunksPerWorker = 4;
+
+// Splits [begin, end) into count roughly equal byte ranges (fewer if the lines are too long)
+// whose boundaries fall just after a '\n'.
+std::vector<std::pair<const char *, const char *>> splitIntoChunks(const char *begin, const char *end,
+                                                                   size_t count) {
+    std::vector<std::pair<const char *, const char *>> chunks;
+    size_t target = static_cast<size_t>(end - begin) / count;
+    const char *start = begin;
+    for (size_t i = 1; i < count && start < end; ++i) {
+        const char *cut = begin + i * target;
+        if (cut <= start)
+            continue;
+        const char *nl = static_cast<const char *>(std::memchr(cut, '\n', static_cast<size_t>(end - cut)));
+        const char *next = nl ? nl + 1 : end;
+        chunks.emplace_back(start, next);
+        start = next;
     }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto tokens = splitLine(line);
-        if (tokens.size() < 3) continue;
-        try {
-            Nation n;
-            n.nationkey = std::stoi(tokens[0]);
-            n.name = tokens[1];
-            n.regionkey = std::stoi(tokens[2]);
-            nations.push_back(n);
-        } catch (const std::exception &e) {
-            std::cerr << "Parsing error in nation file: " << e.what() << "\n";
-        }
+    if (start < end)
+        chunks.emplace_back(start, end);
+    return chunks;
+}
+
+// Line-aligned chunks for loading with workers: up to ChunksPerWorker per worker, but none
+// smaller than MinChunkBytes.
+std::vector<std::pair<const char *, const char *>> splitAtLines(const char *begin, const char *end,
+                                                                size_t workers) {
+    size_t size = static_cast<size_t>(end - begin);
+    size_t count = std::max<size_t>(1, std::min(size / MinChunkBytes, workers * ChunksPerWorker));
+    return splitIntoChunks(begin, end, count);
+}
+
+// Same contract as loadWithStream, but the file is memory mapped and rows are tokenized
+// in place with the SIMD delimiter cursor, so no per-line std::string is ever built.
+// With a pool, the file is cut into line-aligned chunks that are parsed concurrently and
+// then concatenated in file order.
+template <typename Table, size_t N, typename ParseFn>
+Table loadWithMmap(const std::string &filePath, const Table &empty, const char *table,
+                   const FieldTokenizer<N> &tokenizer, ParseFn parseRow, ThreadPool *pool) {
+    Table rows = empty;
+    MappedFile file;
+    if (!file.open(filePath)) {
+        std::cerr << "Error opening " << table << " file: " << filePath << "\n";
+        return rows;
+    }
+    auto chunks = splitAtLines(file.begin(), file.end(), pool ? pool->size() : 1);
+    if (chunks.size() <= 1) {
+        reportRejected(table, parseRange(file.begin(), file.end(), table, tokenizer, parseRow, rows));
+        return rows;
     }
-    return nations;
+
+    std::vector<std::future<std::pair<Table, size_t>>> futures;
+    futures.reserve(chunks.size());
+    for (const auto &chunk : chunks) {
+        futures.push_back(pool->enqueue([chunk, &empty, table, &tokenizer, parseRow]() {
+            Table chunkRows = empty;
+            size_t rejected = parseRange(chunk.first, chunk.second, table, tokenizer, parseRow, chunkRows);
+            return std::make_pair(std::move(chunkRows), rejected);
+        }));
+    }
+    std::vector<Table> parts;
+    parts.reserve(futures.size());
+    size_t total = 0;
+    size_t rejected = 0;
+    for (auto &future : futures) {
+        auto part = future.get();
+        parts.push_back(std::move(part.first));
+        total += parts.back().size();
+        rejected += part.second;
+    }
+    reportRejected(table, rejected);
+    rows.reserve(total);
+    for (auto &part : parts) {
+        appendRows(rows, std::move(part));
+        part = empty;
+    }
+    return rows;
 }
 
-std::vector<Region> DataLoader::loadRegionData(const std::string &filePath) {
-    std::vector<Region> regions;
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        std::cerr << "Error opening region file: " << filePath << "\n";
-        return regions;
+// empty is the table every chunk starts from; for columnar tables it carries the columns to fill.
+template <typename Table, size_t N, typename ParseFn>
+Table loadTable(const std::string &filePath, const LoadOptions &options, ThreadPool *pool, const char *table,
+                const FieldTokenizer<N> &tokenizer, ParseFn parseRow, const Table &empty = Table()) {
+    if (options.method == LoadMethod::Mmap)
+        return loadWithMmap<Table>(filePath, empty, table, tokenizer, parseRow, pool);
+    return loadWithStream<Table>(filePath, empty, table, tokenizer, parseRow);
+}
+
+// An empty columnar table holding the selected columns it supports.
+template <typename Table>
+Table emptyTable(ColumnSet selected) {
+    Table table;
+    table.columns = selected & Table::AllColumns;
+    return table;
+}
+
+// Hands out the fields of a projected row in column order: field(position) returns the next
+// field if position is selected, and nullptr otherwise.
+template <size_t N>
+class ProjectedRow {
+public:
+    ProjectedRow(ColumnSet selected, const std::array<std::string_view, N> &fields)
+        : selected(selected), fields(fields) {}
+
+    const std::string_view *field(int position) {
+        return (selected & columnBit(position)) ? &fields[next++] : nullptr;
     }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto tokens = splitLine(line);
-        if (tokens.size() < 2) continue;
-        try {
-            Region r;
-            r.regionkey = std::stoi(tokens[0]);
-            r.name = tokens[1];
-            regions.push_back(r);
-        } catch (const std::exception &e) {
-            std::cerr << "Parsing error in region file: " << e.what() << "\n";
-        }
+
+private:
+    ColumnSet selected;
+    const std::array<std::string_view, N> &fields;
+    size_t next = 0;
+};
+
+// Parses the selected lineitem fields of a row (shared by loading and streaming).
+auto lineitemParser(const LoadOptions &options, ColumnSet selected) {
+    using T = LineitemTable;
+    using Fields = std::array<std::string_view, 9>;
+    return [convert = FieldConverter(options.validate), selected](const Fields &fields) {
+        ProjectedRow<9> row(selected, fields);
+        Lineitem l{};
+        if (auto f = row.field(T::OrderkeyColumn))
+            l.orderkey = convert.toInt(*f, "l_orderkey");
+        if (auto f = row.field(T::SuppkeyColumn))
+            l.suppkey = convert.toInt(*f, "l_suppkey");
+        if (auto f = row.field(T::QuantityColumn))
+            l.quantity = Money{convert.toHundredths(*f, "l_quantity")};
+        if (auto f = row.field(T::ExtendedpriceColumn))
+            l.extendedprice = Money{convert.toHundredths(*f, "l_extendedprice")};
+        if (auto f = row.field(T::DiscountColumn))
+            l.discount = Money{convert.toHundredths(*f, "l_discount")};
+        if (auto f = row.field(T::TaxColumn))
+            l.tax = Money{convert.toHundredths(*f, "l_tax")};
+        if (auto f = row.field(T::ReturnflagColumn))
+            l.returnflag = convert.toFlag(*f, "l_returnflag");
+        if (auto f = row.field(T::LinestatusColumn))
+            l.linestatus = convert.toFlag(*f, "l_linestatus");
+        if (auto f = row.field(T::ShipdateColumn))
+            l.shipdate = convert.toDate(*f, "l_shipdate");
+        return l;
+    };
+}
+
+} // namespace
+
+// The fields of a row arrive in .tbl column order, so each loader below reads the selected
+// columns in increasing position.
+
+CustomerTable DataLoader::loadCustomerData(const std::string &filePath, const LoadOptions &options,
+                                           ThreadPool *pool) {
+    using T = CustomerTable;
+    CustomerTable empty = emptyTable<CustomerTable>(options.columns.customer);
+    ColumnSet selected = empty.columns;
+    auto parseRow = [convert = FieldConverter(options.validate), selected](const auto &fields) {
+        ProjectedRow<2> row(selected, fields);
+        Customer c{};
+        if (auto f = row.field(T::CustkeyColumn))
+            c.custkey = convert.toInt(*f, "c_custkey");
+        if (auto f = row.field(T::NationkeyColumn))
+            c.nationkey = convert.toInt(*f, "c_nationkey");
+        return c;
+    };
+    return loadTable<CustomerTable>(filePath, options, pool, "customer", FieldTokenizer<2>::fromSet(selected),
+                                    parseRow, empty);
+}
+
+OrdersTable DataLoader::loadOrdersData(const std::string &filePath, const LoadOptions &options,
+                                       ThreadPool *pool) {
+    using T = OrdersTable;
+    OrdersTable empty = emptyTable<OrdersTable>(options.columns.orders);
+    ColumnSet selected = empty.columns;
+    auto parseRow = [convert = FieldConverter(options.validate), selected](const auto &fields) {
+        ProjectedRow<3> row(selected, fields);
+        Orders o{};
+        if (auto f = row.field(T::OrderkeyColumn))
+            o.orderkey = convert.toInt(*f, "o_orderkey");
+        if (auto f = row.field(T::CustkeyColumn))
+            o.custkey = convert.toInt(*f, "o_custkey");
+        if (auto f = row.field(T::OrderdateColumn))
+            o.orderdate = convert.toDate(*f, "o_orderdate");
+        return o;
+    };
+    return loadTable<OrdersTable>(filePath, options, pool, "orders", FieldTokenizer<3>::fromSet(selected),
+                                  parseRow, empty);
+}
+
+LineitemTable DataLoader::loadLineitemData(const std::string &filePath, const LoadOptions &options,
+                                           ThreadPool *pool) {
+    LineitemTable empty = emptyTable<LineitemTable>(options.columns.lineitem);
+    FieldTokenizer<9> tokenizer = FieldTokenizer<9>::fromSet(empty.columns);
+    return loadTable<LineitemTable>(filePath, options, pool, "lineitem", tokenizer,
+                                    lineitemParser(options, empty.columns), empty);
+}
+
+size_t DataLoader::streamLineitemData(const std::string &filePath, const LoadOptions &options,
+                                      ThreadPool &pool, size_t batchRows,
+                                      const LineitemConsumer &consume) {
+    MappedFile file;
+    if (!file.open(filePath)) {
+        std::cerr << "Error opening lineitem file: " << filePath << "\n";
+        return 0;
     }
-    return regions;
+    LineitemTable empty = emptyTable<LineitemTable>(options.columns.lineitem);
+    FieldTokenizer<9> tokenizer = FieldTokenizer<9>::fromSet(empty.columns);
+    auto parseRow = lineitemParser(options, empty.columns);
+
+    // Chunks of MinChunkBytes, however many workers there are: the bytes held at any time are
+    // about one chunk per worker, and each worker reuses one batch of batchRows rows.
+    auto chunks = splitIntoChunks(file.begin(), file.end(), std::max<size_t>(1, file.size() / MinChunkBytes));
+    std::atomic<size_t> rows{0};
+    std::atomic<size_t> rejected{0};
+    morselFor(pool, chunks.size(), 1, [&](size_t worker, size_t first, size_t last) {
+        LineitemTable batch = empty;
+        batch.reserve(batchRows);
+        for (size_t c = first; c < last; c++) {
+            rejected += parseBatches(chunks[c].first, chunks[c].second, "lineitem", tokenizer, parseRow,
+                                     batch, batchRows, [&](const LineitemTable &parsed) {
+                consume(worker, parsed);
+                rows += parsed.size();
+            });
+            file.release(chunks[c].first, chunks[c].second);
+        }
+    });
+    reportRejected("lineitem", rejected);
+    return rows;
+}
+
+SupplierTable DataLoader::loadSupplierData(const std::string &filePath, const LoadOptions &options,
+                                           ThreadPool *pool) {
+    using T = SupplierTable;
+    SupplierTable empty = emptyTable<SupplierTable>(options.columns.supplier);
+    ColumnSet selected = empty.columns;
+    auto parseRow = [convert = FieldConverter(options.validate), selected](const auto &fields) {
+        ProjectedRow<2> row(selected, fields);
+        Supplier s{};
+        if (auto f = row.field(T::SuppkeyColumn))
+            s.suppkey = convert.toInt(*f, "s_suppkey");
+        if (auto f = row.field(T::NationkeyColumn))
+            s.nationkey = convert.toInt(*f, "s_nationkey");
+        return s;
+    };
+    return loadTable<SupplierTable>(filePath, options, pool, "supplier", FieldTokenizer<2>::fromSet(selected),
+                                    parseRow, empty);
+}
+
+std::vector<Nation> DataLoader::loadNationData(const std::string &filePath, const LoadOptions &options,
+                                               ThreadPool *pool) {
+    auto parseRow = [convert = FieldConverter(options.validate)](const auto &fields) {
+        Nation n;
+        n.nationkey = convert.toInt(fields[0], "n_nationkey");
+        n.name = std::string(fields[1]);
+        n.regionkey = convert.toInt(fields[2], "n_regionkey");
+        return n;
+    };
+    return loadTable<std::vector<Nation>>(filePath, options, pool, "nation", FieldTokenizer<3>({0, 1, 2}),
+                                          parseRow);
+}
+
+std::vector<Region> DataLoader::loadRegionData(const std::string &filePath, const LoadOptions &options,
+                                               ThreadPool *pool) {
+    auto parseRow = [convert = FieldConverter(options.validate)](const auto &fields) {
+        Region r;
+        r.regionkey = convert.toInt(fields[0], "r_regionkey");
+        r.name = std::string(fields[1]);
+        return r;
+    };
+    return loadTable<std::vector<Region>>(filePath, options, pool, "region", FieldTokenizer<2>({0, 1}),
+                                          parseRow);
 }
@@ -1,58 +1,345 @@
 #include "data_manager.hpp"
 #include "thread_pool.hpp"
+#include "delimiter_scanner.hpp"
+#include "table_snapshot.hpp"
+#include <sys/stat.h>
 #include <thread>
 #include <iostream>
 
+namespace {
+
+// Small-table string column (n_name, r_name) as one snapshot column of NUL-terminated names.
+template <typename Row>
+std::string joinNames(const std::vector<Row> &rows) {
+    std::string names;
+    for (const Row &row : rows) {
+        names += row.name;
+        names += '\0';
+    }
+    return names;
+}
+
+std::vector<std::string> splitNames(const Column<char> &names) {
+    std::vector<std::string> out;
+    std::string current;
+    for (char c : names) {
+        if (c == '\0') {
+            out.push_back(current);
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    return out;
+}
+
+// Calls visit(name, column, zoneMap) for every integer, decimal and date column of the scanned
+// (columnar) tables; columns that were not loaded are empty.
+template <typename Visit>
+void forEachScannedColumn(DataManager &dm, Visit visit) {
+    visit("l_orderkey", dm.lineitems.orderkey, dm.zoneMaps.lineitemOrderkey);
+    visit("l_extendedprice", dm.lineitems.extendedprice, dm.zoneMaps.lineitemExtendedprice);
+    visit("l_discount", dm.lineitems.discount, dm.zoneMaps.lineitemDiscount);
+    visit("l_suppkey", dm.lineitems.suppkey, dm.zoneMaps.lineitemSuppkey);
+    visit("l_quantity", dm.lineitems.quantity, dm.zoneMaps.lineitemQuantity);
+    visit("l_tax", dm.lineitems.tax, dm.zoneMaps.lineitemTax);
+    visit("l_shipdate", dm.lineitems.shipdate, dm.zoneMaps.lineitemShipdate);
+    visit("o_orderkey", dm.orders.orderkey, dm.zoneMaps.ordersOrderkey);
+    visit("o_custkey", dm.orders.custkey, dm.zoneMaps.ordersCustkey);
+    visit("o_orderdate", dm.orders.orderdate, dm.zoneMaps.ordersOrderdate);
+    visit("c_custkey", dm.customers.custkey, dm.zoneMaps.customerCustkey);
+    visit("c_nationkey", dm.customers.nationkey, dm.zoneMaps.customerNationkey);
+    visit("s_suppkey", dm.suppliers.suppkey, dm.zoneMaps.supplierSuppkey);
+    visit("s_nationkey", dm.suppliers.nationkey, dm.zoneMaps.supplierNationkey);
+}
+
+// Adds the columns table holds to writer, named "<prefix>.<column>".
+template <typename Table>
+void addTable(SnapshotWriter &writer, const char *prefix, const Table &table) {
+    table.forEachColumn([&](int position, const char *name, const auto &column) {
+        if (table.has(position))
+            writer.add(std::string(prefix) + "." + name, column);
+    });
+}
+
+// Maps the columns table is to hold (table.columns) from reader and sets rowCount; false if
+// one is missing or they disagree on the row count.
+template <typename Table>
+bool readTable(const SnapshotReader &reader, const char *prefix, Table &table) {
+    bool complete = true;
+    bool first = true;
+    table.forEachColumn([&](int position, const char *name, auto &column) {
+        if (!complete || !table.has(position))
+            return;
+        complete = reader.column(std::string(prefix) + "." + name, column);
+        if (complete && first)
+            table.rowCount = column.size();
+        else if (complete)
+            complete = column.size() == table.rowCount;
+        first = false;
+    });
+    return complete;
+}
+
+} // namespace
+
 DataManager::DataManager(const std::string &custF, const std::string &ordF,
                          const std::string &lineF, const std::string &suppF,
                          const std::string &natF, const std::string &regF, const int threads)
     : customerFile(custF), ordersFile(ordF), lineitemFile(lineF),
       supplierFile(suppF), nationFile(natF), regionFile(regF), dataLoaded(false), pool(threads) {}
 
-void DataManager::loadAllTables()
+void DataManager::loadAllTables(const LoadOptions &options)
 {
+    if (options.snapshot.empty() || !loadSnapshot(options.snapshot, options))
+    {
+        loadTextTables(options);
+        if (options.compress)
+            encodeTables();
+        if (!options.snapshot.empty() && writeSnapshot(options.snapshot, options))
+            std::cout << "Wrote snapshot " << options.snapshot << ".\n";
+    }
+    std::cout << "All tables loaded successfully.\n";
+    buildJoinIndexes();
+    buildZoneMaps();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        dataLoaded = true;
+    }
+    cv.notify_all(); // Notify all waiting threads that data is loaded.
+    processQueuedQueries(); // Process any queued queries.
+    std::cout << "Queued queries processed.\n";
+    std::cout << "Data loading complete.\n";
+}
 
-    auto f1 = pool.enqueue([this]()
-                           {
-        customers = DataLoader::loadCustomerData(customerFile);
-        std::cout << "Loaded " << customers.size() << " customer records.\n"; });
-    auto f2 = pool.enqueue([this]()
-                           {
-        orders = DataLoader::loadOrdersData(ordersFile);
-        std::cout << "Loaded " << orders.size() << " orders records.\n"; });
-    auto f3 = pool.enqueue([this]()
-                           {
-        lineitems = DataLoader::loadLineitemData(lineitemFile);
-        std::cout << "Loaded " << lineitems.size() << " lineitem records.\n"; });
-    auto f4 = pool.enqueue([this]()
+void DataManager::loadTextTables(const LoadOptions &options)
+{
+    std::cout << "Delimiter scanner: " << delimiterKernelName() << "\n";
+
+    // The small tables are loaded whole, one task each.
+    auto f4 = pool.enqueue([this, &options]()
                            {
-        suppliers = DataLoader::loadSupplierData(supplierFile);
+        suppliers = DataLoader::loadSupplierData(supplierFile, options);
         std::cout << "Loaded " << suppliers.size() << " supplier records.\n"; });
-    auto f5 = pool.enqueue([this]()
+    auto f5 = pool.enqueue([this, &options]()
                            {
-        nations = DataLoader::loadNationData(nationFile);
+        nations = DataLoader::loadNationData(nationFile, options);
         std::cout << "Loaded " << nations.size() << " nation records.\n"; });
-    auto f6 = pool.enqueue([this]()
+    auto f6 = pool.enqueue([this, &options]()
                            {
-        regions = DataLoader::loadRegionData(regionFile);
+        regions = DataLoader::loadRegionData(regionFile, options);
         std::cout << "Loaded " << regions.size() << " region records.\n"; });
 
+    // With Mmap the large tables are split into chunks that are parsed on the pool. Those
+    // loaders wait for their chunks, so they run on this thread rather than as pool tasks.
+    // Stream reads a file on one thread and never uses the pool, so there each large table is
+    // a pool task of its own and the three files are parsed in parallel.
+    ThreadPool *chunkPool = options.method == LoadMethod::Mmap ? &pool : nullptr;
+    auto loadLineitems = [this, &options, chunkPool]()
+    {
+        // A query that streams lineitem (DataLoader::streamLineitemData) selects none of its
+        // columns, and the file is not read here at all.
+        if (options.columns.lineitem & LineitemTable::AllColumns)
+        {
+            lineitems = DataLoader::loadLineitemData(lineitemFile, options, chunkPool);
+            std::cout << "Loaded " << lineitems.size() << " lineitem records.\n";
+        }
+        else
+        {
+            lineitems = LineitemTable();
+            lineitems.columns = 0;
+            std::cout << "Lineitem not loaded (no columns selected).\n";
+        }
+    };
+    auto loadOrders = [this, &options, chunkPool]()
+    {
+        orders = DataLoader::loadOrdersData(ordersFile, options, chunkPool);
+        std::cout << "Loaded " << orders.size() << " orders records.\n";
+    };
+    auto loadCustomers = [this, &options, chunkPool]()
+    {
+        customers = DataLoader::loadCustomerData(customerFile, options, chunkPool);
+        std::cout << "Loaded " << customers.size() << " customer records.\n";
+    };
+    if (chunkPool != nullptr)
+    {
+        loadLineitems();
+        loadOrders();
+        loadCustomers();
+    }
+    else
+    {
+        auto f1 = pool.enqueue(loadLineitems);
+        auto f2 = pool.enqueue(loadOrders);
+        auto f3 = pool.enqueue(loadCustomers);
+        f1.get();
+        f2.get();
+        f3.get();
+    }
+
     // Wait for all loading tasks to finish.
-    f1.get();
-    f2.get();
-    f3.get();
     f4.get();
     f5.get();
     f6.get();
-    std::cout << "All tables loaded successfully.\n";
+}
+
+void DataManager::encodeTables()
+{
+    size_t before = 0, after = 0;
+    std::vector<std::function<void()>> encoders;
+    forEachScannedColumn(*this, [&](const char *, auto &column, ZoneMap &) {
+        before += column.sizeBytes();
+        encoders.push_back([&column]() { column.encode(); });
+    });
+    // One task per column: a min/max pass, a distinct-value pass that gives up early on
+    // high-cardinality columns, and a packing pass.
+    pool.parallelFor(encoders.size(), [&encoders](size_t i) { encoders[i](); });
+
+    std::cout << "Column encodings (unpack kernel: " << unpackKernelName() << "):";
+    forEachScannedColumn(*this, [&](const char *name, auto &column, ZoneMap &) {
+        after += column.sizeBytes();
+        std::cout << " " << name << "=" << columnEncodingName(column.encoding());
+        if (column.isEncoded())
+            std::cout << "/" << column.packedBits();
+    });
+    std::cout << "\nEncoded columns: " << before / (1024 * 1024) << " MB -> " << after / (1024 * 1024) << " MB.\n";
+}
+
+bool DataManager::snapshotFingerprint(const LoadOptions &options, uint64_t &fingerprint, std::string &error) const
+{
+    std::string identity = "validate=" + std::to_string(options.validate) + ",compress=" + std::to_string(options.compress) +
+                           ",columns=" + std::to_string(options.columns.customer) + "/" + std::to_string(options.columns.orders) +
+                           "/" + std::to_string(options.columns.lineitem) + "/" + std::to_string(options.columns.supplier);
+    for (const std::string *path : {&customerFile, &ordersFile, &lineitemFile, &supplierFile, &nationFile, &regionFile})
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        dataLoaded = true;
+        struct stat st {};
+        if (stat(path->c_str(), &st) != 0)
+        {
+            error = "cannot stat " + *path;
+            return false;
+        }
+        identity += "|" + *path + ":" + std::to_string(st.st_size) + ":" + std::to_string(st.st_mtim.tv_sec) +
+                    "." + std::to_string(st.st_mtim.tv_nsec);
     }
-    cv.notify_all(); // Notify all waiting threads that data is loaded.
-    processQueuedQueries(); // Process any queued queries.
-    std::cout << "Queued queries processed.\n";
-    std::cout << "Data loading complete.\n";
+    fingerprint = snapshotChecksum(identity.data(), identity.size());
+    return true;
+}
+
+bool DataManager::writeSnapshot(const std::string &path, const LoadOptions &options) const
+{
+    std::vector<int> nationKeys, nationRegions, regionKeys;
+    for (const Nation &n : nations)
+    {
+        nationKeys.push_back(n.nationkey);
+        nationRegions.push_back(n.regionkey);
+    }
+    for (const Region &r : regions)
+        regionKeys.push_back(r.regionkey);
+    std::string nationNames = joinNames(nations);
+    std::string regionNames = joinNames(regions);
+
+    SnapshotWriter writer;
+    addTable(writer, "customer", customers);
+    addTable(writer, "orders", orders);
+    addTable(writer, "lineitem", lineitems);
+    addTable(writer, "supplier", suppliers);
+    writer.add("nation.n_nationkey", nationKeys.data(), nationKeys.size(), sizeof(int));
+    writer.add("nation.n_regionkey", nationRegions.data(), nationRegions.size(), sizeof(int));
+    writer.add("nation.n_name", nationNames.data(), nationNames.size(), 1);
+    writer.add("region.r_regionkey", regionKeys.data(), regionKeys.size(), sizeof(int));
+    writer.add("region.r_name", regionNames.data(), regionNames.size(), 1);
+
+    std::string error;
+    uint64_t fingerprint;
+    if (!snapshotFingerprint(options, fingerprint, error) || !writer.write(path, fingerprint, error))
+    {
+        std::cerr << "Could not write snapshot " << path << ": " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool DataManager::loadSnapshot(const std::string &path, const LoadOptions &options)
+{
+    SnapshotReader reader;
+    std::string error;
+    uint64_t fingerprint;
+    if (!snapshotFingerprint(options, fingerprint, error) || !reader.open(path, fingerprint, error) ||
+        (options.verifySnapshot && !reader.verify(error, &pool)))
+    {
+        std::cerr << "Not using snapshot " << path << ": " << error << "\n";
+        return false;
+    }
+
+    CustomerTable c;
+    OrdersTable o;
+    LineitemTable l;
+    SupplierTable s;
+    c.columns = options.columns.customer & CustomerTable::AllColumns;
+    o.columns = options.columns.orders & OrdersTable::AllColumns;
+    l.columns = options.columns.lineitem & LineitemTable::AllColumns;
+    s.columns = options.columns.supplier & SupplierTable::AllColumns;
+    Column<int> nationKeys, nationRegions, regionKeys;
+    Column<char> nationNames, regionNames;
+    bool complete = readTable(reader, "customer", c) && readTable(reader, "orders", o) &&
+                    readTable(reader, "lineitem", l) && readTable(reader, "supplier", s) &&
+                    reader.column("nation.n_nationkey", nationKeys) && reader.column("nation.n_regionkey", nationRegions) &&
+                    reader.column("nation.n_name", nationNames) &&
+                    reader.column("region.r_regionkey", regionKeys) && reader.column("region.r_name", regionNames);
+    std::vector<std::string> nationNameList = splitNames(nationNames);
+    std::vector<std::string> regionNameList = splitNames(regionNames);
+    complete = complete && nationRegions.size() == nationKeys.size() && nationNameList.size() == nationKeys.size() &&
+               regionNameList.size() == regionKeys.size();
+    if (!complete)
+    {
+        std::cerr << "Not using snapshot " << path << ": missing or inconsistent columns\n";
+        return false;
+    }
+
+    customers = std::move(c);
+    orders = std::move(o);
+    lineitems = std::move(l);
+    suppliers = std::move(s);
+    nations.clear();
+    for (size_t i = 0; i < nationKeys.size(); i++)
+        nations.push_back(Nation{nationKeys[i], nationNameList[i], nationRegions[i]});
+    regions.clear();
+    for (size_t i = 0; i < regionKeys.size(); i++)
+        regions.push_back(Region{regionKeys[i], regionNameList[i]});
+    std::cout << "Mapped snapshot " << path << ": " << lineitems.size() << " lineitem, " << orders.size()
+              << " orders, " << customers.size() << " customer, " << suppliers.size() << " supplier, "
+              << nations.size() << " nation, " << regions.size() << " region records.\n";
+    return true;
+}
+
+void DataManager::buildJoinIndexes()
+{
+    // The large indexes split their build passes into morsels on the pool, so they are built
+    // from this thread; the small ones are not worth a task.
+    // A table loaded without its key column gets an empty index.
+    indexes.orders.build(orders.has(OrdersTable::OrderkeyColumn) ? orders.size() : 0,
+                         [this](size_t i) { return orders.orderkey[i]; }, &pool);
+    indexes.customers.build(customers.has(CustomerTable::CustkeyColumn) ? customers.size() : 0,
+                            [this](size_t i) { return customers.custkey[i]; }, &pool);
+    indexes.suppliers.build(suppliers.has(SupplierTable::SuppkeyColumn) ? suppliers.size() : 0,
+                            [this](size_t i) { return suppliers.suppkey[i]; }, &pool);
+    indexes.nations.build(nations.size(), [this](size_t i) { return nations[i].nationkey; });
+    indexes.regions.build(regions.size(), [this](size_t i) { return regions[i].regionkey; });
+    std::cout << "Join indexes built (orders: " << (indexes.orders.isDense() ? "dense" : "hashed")
+              << ", customer: " << (indexes.customers.isDense() ? "dense" : "hashed")
+              << ", supplier: " << (indexes.suppliers.isDense() ? "dense" : "hashed") << ").\n";
+}
+
+void DataManager::buildZoneMaps()
+{
+    // One pass over each column, one task per column.
+    std::vector<std::function<void()>> builders;
+    forEachScannedColumn(*this, [&](const char *, const auto &column, ZoneMap &zoneMap) {
+        builders.push_back([&column, &zoneMap]() { zoneMap.build(column); });
+    });
+    pool.parallelFor(builders.size(), [&builders](size_t i) { builders[i](); });
+    std::cout << "Zone maps built (" << zoneMaps.lineitemOrderkey.blockCount() << " lineitem, "
+              << zoneMaps.ordersOrderkey.blockCount() << " orders blocks of " << ZoneMap::BlockRows << " rows).\n";
 }
 
 void DataManager::processQuery(std::function<void()> query)
@@ -0,0 +1,63 @@
+#include "delimiter_scanner.hpp"
+#include "cpu_dispatch.hpp"
+
+namespace {
+
+DelimiterMasks scanScalar(const char *block, char fieldDelimiter, char lineDelimiter) {
+    DelimiterMasks masks = {0, 0};
+    for (unsigned i = 0; i < DelimiterCursor::BlockSize; ++i) {
+        masks.field |= static_cast<uint64_t>(block[i] == fieldDelimiter) << i;
+        masks.line |= static_cast<uint64_t>(block[i] == lineDelimiter) << i;
+    }
+    return masks;
+}
+
+#ifdef CPU_DISPATCH_X86
+
+__attribute__((target("sse4.2")))
+DelimiterMasks scanSse42(const char *block, char fieldDelimiter, char lineDelimiter) {
+    const __m128i field = _mm_set1_epi8(fieldDelimiter);
+    const __m128i line = _mm_set1_epi8(lineDelimiter);
+    DelimiterMasks masks = {0, 0};
+    for (unsigned i = 0; i < 4; ++i) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+        masks.field |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, field)))) << (16 * i);
+        masks.line |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, line)))) << (16 * i);
+    }
+    return masks;
+}
+
+__attribute__((target("avx2")))
+DelimiterMasks scanAvx2(const char *block, char fieldDelimiter, char lineDelimiter) {
+    const __m256i field = _mm256_set1_epi8(fieldDelimiter);
+    const __m256i line = _mm256_set1_epi8(lineDelimiter);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+    uint64_t fieldLo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, field)));
+    uint64_t fieldHi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, field)));
+    uint64_t lineLo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, line)));
+    uint64_t lineHi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, line)));
+    return {fieldLo | (fieldHi << 32), lineLo | (lineHi << 32)};
+}
+
+#endif
+
+const KernelChoice<DelimiterKernel> &activeKernel() {
+    static const KernelChoice<DelimiterKernel> choice = selectKernel<DelimiterKernel>({
+#ifdef CPU_DISPATCH_X86
+        {CpuFeature::Avx2, scanAvx2},
+        {CpuFeature::Sse42, scanSse42},
+#endif
+    }, scanScalar);
+    return choice;
+}
+
+} // namespace
+
+DelimiterKernel delimiterKernel() {
+    return activeKernel().kernel;
+}
+
+const char *delimiterKernelName() {
+    return activeKernel().name;
+}
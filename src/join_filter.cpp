@@ -0,0 +1,156 @@
+#include "join_filter.hpp"
+#include "cpu_dispatch.hpp"
+#include <algorithm>
+
+namespace {
+
+// Per-word multipliers of the split-block Bloom filter (as used by Impala and Parquet).
+alignas(32) const uint32_t Salt[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                      0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+inline uint64_t hashKey(int key) {
+    uint64_t h = static_cast<uint64_t>(static_cast<uint32_t>(key)) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+}
+
+// Block chosen by the high half of the hash, spread over numBlocks without a modulo.
+inline size_t blockOf(uint64_t h, size_t numBlocks) {
+    return static_cast<size_t>(((h >> 32) * numBlocks) >> 32);
+}
+
+inline bool bloomCheckScalar(const JoinFilter::Block &block, uint32_t lo) {
+    for (int i = 0; i < 8; i++) {
+        uint32_t bit = 1u << ((lo * Salt[i]) >> 27);
+        if ((block.words[i] & bit) == 0)
+            return false;
+    }
+    return true;
+}
+
+using BloomBatchKernel = size_t (*)(const JoinFilter::Block *blocks, size_t numBlocks, const int *keys,
+                                    const uint32_t *sel, size_t n, uint32_t *out);
+
+size_t bloomBatchScalar(const JoinFilter::Block *blocks, size_t numBlocks, const int *keys,
+                        const uint32_t *sel, size_t n, uint32_t *out) {
+    size_t passed = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t pos = sel ? sel[i] : static_cast<uint32_t>(i);
+        uint64_t h = hashKey(keys[pos]);
+        out[passed] = pos;
+        passed += bloomCheckScalar(blocks[blockOf(h, numBlocks)], static_cast<uint32_t>(h));
+    }
+    return passed;
+}
+
+#ifdef CPU_DISPATCH_X86
+
+__attribute__((target("avx2")))
+size_t bloomBatchAvx2(const JoinFilter::Block *blocks, size_t numBlocks, const int *keys,
+                      const uint32_t *sel, size_t n, uint32_t *out) {
+    const __m256i salt = _mm256_load_si256(reinterpret_cast<const __m256i *>(Salt));
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t passed = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t pos = sel ? sel[i] : static_cast<uint32_t>(i);
+        uint64_t h = hashKey(keys[pos]);
+        __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(h))), salt), 27);
+        __m256i mask = _mm256_sllv_epi32(one, shifts);
+        __m256i block = _mm256_load_si256(reinterpret_cast<const __m256i *>(&blocks[blockOf(h, numBlocks)]));
+        out[passed] = pos;
+        // testc: (~block & mask) == 0, i.e. every bit of mask is set in the block.
+        passed += static_cast<size_t>(_mm256_testc_si256(block, mask));
+    }
+    return passed;
+}
+
+#endif
+
+BloomBatchKernel bloomKernel() {
+    static const KernelChoice<BloomBatchKernel> choice = selectKernel<BloomBatchKernel>({
+#ifdef CPU_DISPATCH_X86
+        {CpuFeature::Avx2, bloomBatchAvx2},
+#endif
+    }, bloomBatchScalar);
+    return choice.kernel;
+}
+
+} // namespace
+
+JoinFilter &JoinFilter::operator=(JoinFilter &&other) noexcept {
+    filterKind = other.filterKind;
+    minKey = other.minKey;
+    range = other.range;
+    bits = std::move(other.bits);
+    blocks = std::move(other.blocks);
+    probedRows.store(other.probedRows.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    passedRows.store(other.passedRows.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+void JoinFilter::build(const int *keys, size_t count) {
+    bits.clear();
+    blocks.clear();
+    resetCounters();
+    filterKind = Kind::Bitmap;
+    minKey = 0;
+    range = 0;
+    if (count == 0)
+        return;
+
+    int lo = *std::min_element(keys, keys + count);
+    int hi = *std::max_element(keys, keys + count);
+    uint64_t keyRange = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+    if (keyRange <= MaxBitmapBitsPerKey * count) {
+        minKey = lo;
+        range = keyRange;
+        bits.assign((keyRange + 63) / 64, 0);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(keys[i]) - lo);
+            bits[offset >> 6] |= 1ULL << (offset & 63);
+        }
+        return;
+    }
+
+    filterKind = Kind::Bloom;
+    size_t numBlocks = std::max<size_t>(1, (count * BloomBitsPerKey + 255) / 256);
+    blocks.assign(numBlocks, Block{});
+    for (size_t i = 0; i < count; i++) {
+        uint64_t h = hashKey(keys[i]);
+        Block &block = blocks[blockOf(h, numBlocks)];
+        uint32_t hashLo = static_cast<uint32_t>(h);
+        for (int w = 0; w < 8; w++)
+            block.words[w] |= 1u << ((hashLo * Salt[w]) >> 27);
+    }
+}
+
+bool JoinFilter::mayContain(int key) const {
+    if (filterKind == Kind::Bitmap) {
+        uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(key) - minKey);
+        return offset < range && ((bits[offset >> 6] >> (offset & 63)) & 1);
+    }
+    uint64_t h = hashKey(key);
+    return bloomCheckScalar(blocks[blockOf(h, blocks.size())], static_cast<uint32_t>(h));
+}
+
+size_t JoinFilter::probeBatch(const int *keys, const uint32_t *sel, size_t n, uint32_t *out) const {
+    size_t passed = 0;
+    if (filterKind == Kind::Bitmap) {
+        const uint64_t *words = bits.data();
+        for (size_t i = 0; i < n; i++) {
+            uint32_t pos = sel ? sel[i] : static_cast<uint32_t>(i);
+            uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(keys[pos]) - minKey);
+            out[passed] = pos;
+            passed += offset < range && ((words[offset >> 6] >> (offset & 63)) & 1);
+        }
+    } else {
+        passed = bloomKernel()(blocks.data(), blocks.size(), keys, sel, n, out);
+    }
+    probedRows.fetch_add(n, std::memory_order_relaxed);
+    passedRows.fetch_add(passed, std::memory_order_relaxed);
+    return passed;
+}
+
+void JoinFilter::resetCounters() {
+    probedRows.store(0, std::memory_order_relaxed);
+    passedRows.store(0, std::memory_order_relaxed);
+}
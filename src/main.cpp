@@ -1,16 +1,34 @@
 #include "data_manager.hpp"
 #include "thread_pool.hpp"
+#include "field_parsers.hpp"
+#include "morsel_dispatcher.hpp"
+#include "q5_pipeline.hpp"
+#include "radix_join.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <cstdlib>
 #include <vector>
 
+// How lineitem is joined with orders.
+// Index: probe the (semi-join reduced) orders key map.
+// Radix: partition both sides on the pool and hash-join partition by partition (RadixJoin).
+enum class JoinStrategy {
+    Index,
+    Radix
+};
+
 // Structure for CLI options.
 struct CLIOptions {
     std::string region;
     std::string startDate;
     std::string endDate;
+    int32_t startDay;        // startDate/endDate as days since 1970-01-01, converted once.
+    int32_t endDay;
     int threads;             // Number of threads to use for query processing.
     std::string customerPath;
     std::string ordersPath;
@@ -19,13 +37,19 @@ struct CLIOptions {
     std::string nationPath;
     std::string regionPath;
     std::string resultPath;
+    LoadOptions load;        // How table files are read (--load-method, --validate, --compression, --snapshot, --verify-snapshot).
+    JoinStrategy join = JoinStrategy::Index; // --join
+    bool prefetch = false;   // --prefetch: group-prefetch join probes in the lineitem scan.
+    bool streaming = false;  // --streaming: parse lineitem during the query instead of loading it.
+    bool verbose = false;    // --verbose: report scheduling details.
 };
 
 void printUsage(const char *progName) {
     std::cout << "Usage: " << progName 
               << " --region <region> --start-date <start_date> --end-date <end_date> --threads <num_threads> "
               << "--customer <customer_file> --orders <orders_file> --lineitem <lineitem_file> "
-              << "--supplier <supplier_file> --nation <nation_file> --regionfile <region_file> --result <result_file>\n";
+              << "--supplier <supplier_file> --nation <nation_file> --regionfile <region_file> --result <result_file> "
+              << "[--load-method <stream|mmap>] [--validate] [--join <index|radix>] [--prefetch <on|off>] [--compression <on|off>] [--snapshot <file>] [--verify-snapshot <on|off>] [--streaming] [--verbose]\n";
 }
 
 CLIOptions parseCLI(int argc, char *argv[]) {
@@ -54,12 +78,79 @@ CLIOptions parseCLI(int argc, char *argv[]) {
             opts.regionPath = argv[++i];
         } else if (arg == "--result" && i + 1 < argc) {
             opts.resultPath = argv[++i];
+        } else if (arg == "--load-method" && i + 1 < argc) {
+            std::string method = argv[++i];
+            if (method == "stream") {
+                opts.load.method = LoadMethod::Stream;
+            } else if (method == "mmap") {
+                opts.load.method = LoadMethod::Mmap;
+            } else {
+                std::cerr << "Unknown load method: " << method << "\n";
+                printUsage(argv[0]);
+                exit(1);
+            }
+        } else if (arg == "--join" && i + 1 < argc) {
+            std::string join = argv[++i];
+            if (join == "index") {
+                opts.join = JoinStrategy::Index;
+            } else if (join == "radix") {
+                opts.join = JoinStrategy::Radix;
+            } else {
+                std::cerr << "Unknown join strategy: " << join << "\n";
+                printUsage(argv[0]);
+                exit(1);
+            }
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            std::string prefetch = argv[++i];
+            if (prefetch == "on" || prefetch == "off") {
+                opts.prefetch = prefetch == "on";
+            } else {
+                std::cerr << "Unknown prefetch setting: " << prefetch << "\n";
+                printUsage(argv[0]);
+                exit(1);
+            }
+        } else if (arg == "--compression" && i + 1 < argc) {
+            std::string compression = argv[++i];
+            if (compression == "on" || compression == "off") {
+                opts.load.compress = compression == "on";
+            } else {
+                std::cerr << "Unknown compression setting: " << compression << "\n";
+                printUsage(argv[0]);
+                exit(1);
+            }
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            opts.load.snapshot = argv[++i];
+        } else if (arg == "--verify-snapshot" && i + 1 < argc) {
+            std::string verify = argv[++i];
+            if (verify == "on" || verify == "off") {
+                opts.load.verifySnapshot = verify == "on";
+            } else {
+                std::cerr << "Unknown snapshot verification setting: " << verify << "\n";
+                printUsage(argv[0]);
+                exit(1);
+            }
+        } else if (arg == "--streaming") {
+            opts.streaming = true;
+        } else if (arg == "--verbose") {
+            opts.verbose = true;
+        } else if (arg == "--validate") {
+            opts.load.validate = true;
         } else {
             std::cerr << "Unknown parameter: " << arg << "\n";
             printUsage(argv[0]);
             exit(1);
         }
     }
+    if (!tryParseDate(opts.startDate, opts.startDay) || !tryParseDate(opts.endDate, opts.endDay)) {
+        std::cerr << "Dates must be given as YYYY-MM-DD: " << opts.startDate << ", " << opts.endDate << "\n";
+        printUsage(argv[0]);
+        exit(1);
+    }
+    if (opts.streaming && opts.join == JoinStrategy::Radix) {
+        std::cerr << "--streaming probes the orders index and cannot be combined with --join radix\n";
+        printUsage(argv[0]);
+        exit(1);
+    }
     return opts;
 }
 
@@ -70,112 +161,104 @@ void executeQuery(DataManager &dm, const CLIOptions &opts) {
     std::cout << "Start Date: " << opts.startDate << "\n";
     std::cout << "End Date: " << opts.endDate << "\n";
     std::cout << "Query Processing Threads: " << opts.threads << "\n";
+    auto queryStart = std::chrono::steady_clock::now();
     
-    // Build hash maps for quick lookup.
-    std::unordered_map<int, Orders> orderMap;
-    for (const auto &o : dm.orders) {
-        orderMap[o.orderkey] = o;
-    }
+    // Reduce orders and suppliers to the ones that can contribute before touching lineitem.
+    Q5Plan plan = planQ5(dm, opts.region, opts.startDay, opts.endDay);
     
-    std::unordered_map<int, Supplier> supplierMap;
-    for (const auto &s : dm.suppliers) {
-        supplierMap[s.suppkey] = s;
-    }
+    // Scan only the lineitem columns the query needs.
+    const Column<int> &orderkeys = dm.lineitems.orderkey;
+    const Column<int> &suppkeys = dm.lineitems.suppkey;
+    const Column<Money> &prices = dm.lineitems.extendedprice;
+    const Column<Money> &discounts = dm.lineitems.discount;
     
-    std::unordered_map<int, Customer> customerMap;
-    for (const auto &c : dm.customers) {
-        customerMap[c.custkey] = c;
-    }
-    
-    std::unordered_map<int, Nation> nationMap;
-    for (const auto &n : dm.nations) {
-        nationMap[n.nationkey] = n;
-    }
-    
-    std::unordered_map<int, Region> regionMap;
-    for (const auto &r : dm.regions) {
-        regionMap[r.regionkey] = r;
-    }
-    
-    // Partition the lineitems vector for parallel processing.
-    int threadCount = opts.threads;
     size_t total = dm.lineitems.size();
-    size_t partitionSize = (threadCount > 0) ? total / threadCount : total;
     
-    // Each task returns a local revenue map: nation name -> revenue.
-    std::vector<std::future<std::unordered_map<std::string, double>>> futures;
+    // Revenue per nation row, one padded accumulator row per pool worker.
+    Q5Pipeline::Revenue revenue(dm.nations.size(), std::max<size_t>(dm.pool.size(), 1));
     
-    
-    for (int i = 0; i < threadCount; i++) {
-        size_t start = i * partitionSize;
-        size_t end = (i == threadCount - 1) ? total : (i + 1) * partitionSize;
-        
-        futures.push_back(dm.pool.enqueue([=, &dm, &orderMap, &supplierMap, &customerMap, &nationMap, &regionMap, &opts]() -> std::unordered_map<std::string, double> {
-            std::unordered_map<std::string, double> localRevenue;
-            for (size_t j = start; j < end; j++) {
-                const auto &li = dm.lineitems[j];
-                // Join: l_orderkey = o_orderkey
-                auto orderIt = orderMap.find(li.orderkey);
-                if(orderIt == orderMap.end())
-                    continue;
-                const Orders &o = orderIt->second;
-                
-                // Filter on order date.
-                if(o.orderdate < opts.startDate || o.orderdate >= opts.endDate)
-                    continue;
-                
-                // Join: l_suppkey = s_suppkey
-                auto suppIt = supplierMap.find(li.suppkey);
-                if(suppIt == supplierMap.end())
-                    continue;
-                const Supplier &s = suppIt->second;
-                
-                // Join: c_custkey = o_custkey
-                auto custIt = customerMap.find(o.custkey);
-                if(custIt == customerMap.end())
-                    continue;
-                const Customer &c = custIt->second;
-                
-                // Condition: c_nationkey = s_nationkey
-                if(c.nationkey != s.nationkey)
-                    continue;
-                
-                // Join: s_nationkey = n_nationkey
-                auto natIt = nationMap.find(s.nationkey);
-                if(natIt == nationMap.end())
-                    continue;
-                const Nation &n = natIt->second;
-                
-                // Join: n_regionkey = r_regionkey 
-                auto regIt = regionMap.find(n.regionkey);
-                if(regIt == regionMap.end())
-                    continue;
-                const Region &r = regIt->second;
-
-                // filter: r_name must equal opts.region
-                if(r.name != opts.region)
-                    continue;
-                
-                // All conditions satisfied: compute revenue.
-                double revenue = li.extendedprice * (1.0 - li.discount);
-                // Group revenue by nation name.
-                localRevenue[n.name] += revenue;
+    if (opts.join == JoinStrategy::Radix) {
+        // Partition the qualifying orders and lineitem on the pool and join partition by partition.
+        // Matches arrive one row at a time, so this path keeps a row-wise predicate:
+        // lineitem row j belongs to qualifying order o, whose customer is in nation row n. It is
+        // kept if its supplier qualifies too and is in the same nation (c_nationkey = s_nationkey).
+        // Partitioning reads l_orderkey as one array, so an encoded column is unpacked first;
+        // the other columns are decoded only for the matches.
+        std::vector<int> decodedKeys(orderkeys.isEncoded() ? total : 0);
+        const int *keys = orderkeys.read(0, total, decodedKeys.data());
+        RadixJoin join(dm.pool);
+        join.build(plan.orderKeys.data(), plan.orderKeys.size());
+        join.probe(keys, total, revenue.taskCount(), [&](size_t task, uint32_t j, uint32_t o) {
+            uint8_t n = plan.orderNations[o];
+            if(plan.supplierNation.find(suppkeys[j]) == n)
+                revenue.add(task, n, discountedPrice(prices[j], discounts[j]));
+        });
+    } else if (opts.streaming) {
+        // lineitem was not loaded: parse it now, chunk by chunk on the pool, and push every
+        // parsed batch through the pipeline of the worker that parsed it. Only the batches and
+        // chunks being worked on are held.
+        LoadOptions streamOptions = opts.load;
+        streamOptions.columns.lineitem = q5Columns().lineitem;
+        std::vector<std::unique_ptr<Q5Pipeline>> pipelines(revenue.taskCount());
+        size_t streamed = DataLoader::streamLineitemData(dm.lineitemFile, streamOptions, dm.pool, Q5Pipeline::BatchRows,
+                                                         [&](size_t worker, const LineitemTable &batch) {
+            if (!pipelines[worker])
+                pipelines[worker] = std::make_unique<Q5Pipeline>(plan, revenue.local(worker), opts.prefetch);
+            pipelines[worker]->consume({batch.orderkey.data(), batch.suppkey.data(), &batch.extendedprice,
+                                        &batch.discount, 0, batch.size()});
+        });
+        std::cout << "Streamed " << streamed << " lineitem rows.\n";
+    } else {
+        // Workers pull lineitem morsels from a shared cursor until the table is exhausted, so
+        // a slow worker takes fewer morsels instead of holding up the scan.
+        // Morsels are zone map blocks: one whose l_orderkey or l_suppkey range misses the
+        // qualifying keys is skipped unread.
+        std::atomic<size_t> skippedBlocks{0};
+        std::vector<size_t> morsels = morselFor(dm.pool, total, ZoneMap::BlockRows,
+                                                [&](size_t worker, size_t start, size_t end) {
+            if (!dm.zoneMaps.lineitemOrderkey.mayContain(start, end, plan.minOrderKey, plan.maxOrderKey) ||
+                !dm.zoneMaps.lineitemSuppkey.mayContain(start, end, plan.minSuppKey, plan.maxSuppKey)) {
+                skippedBlocks++;
+                return;
+            }
+            // Push the morsel through the Q5 pipeline one batch at a time.
+            // Encoded join keys are unpacked batch by batch into these buffers with the SIMD
+            // kernel; plain columns are read in place.
+            Q5Pipeline pipeline(plan, revenue.local(worker), opts.prefetch);
+            int orderkeyBatch[Q5Pipeline::BatchRows], suppkeyBatch[Q5Pipeline::BatchRows];
+            for (size_t base = start; base < end; base += Q5Pipeline::BatchRows) {
+                size_t len = std::min(Q5Pipeline::BatchRows, end - base);
+                pipeline.consume({orderkeys.read(base, len, orderkeyBatch), suppkeys.read(base, len, suppkeyBatch),
+                                  &prices, &discounts, base, len});
             }
-            return localRevenue;
-        }));
+        });
+        if (opts.verbose) {
+            std::cout << "Lineitem morsels per worker:";
+            for (size_t count : morsels)
+                std::cout << " " << count;
+            std::cout << "\n";
+        }
+        std::cout << "Zone maps skipped " << skippedBlocks << " of " << dm.zoneMaps.lineitemOrderkey.blockCount()
+                  << " lineitem blocks.\n";
+    }
+    if (opts.join == JoinStrategy::Index) {
+        std::cout << "Join filter on l_orderkey (" << plan.orderFilter.kindName() << ", "
+                  << plan.orderFilter.sizeBytes() / 1024 << " KB) eliminated "
+                  << plan.orderFilter.eliminated() << " of " << plan.orderFilter.probed() << " rows.\n";
+        std::cout << "Join filter on l_suppkey (" << plan.supplierFilter.kindName() << ", "
+                  << plan.supplierFilter.sizeBytes() / 1024 << " KB) eliminated "
+                  << plan.supplierFilter.eliminated() << " of " << plan.supplierFilter.probed() << " rows.\n";
     }
     
-    // Merge the partial maps.
-    std::unordered_map<std::string, double> resultRevenue;
-    for (auto &future : futures) {
-        auto partial = future.get();
-        for (const auto &p : partial) {
-            resultRevenue[p.first] += p.second;
-        }
+    // Merge the task rows and resolve nation rows to names.
+    std::vector<std::pair<std::string, Decimal<4>>> sortedResults;
+    std::vector<Q5Pipeline::Revenue::Slot> totals = revenue.merge();
+    for (size_t n = 0; n < totals.size(); n++) {
+        if (totals[n].rows > 0)
+            sortedResults.emplace_back(dm.nations[n].name, totals[n].sum);
     }
     
-    // Convert the map to a vector and sort descending by revenue.
-    std::vector<std::pair<std::string, double>> sortedResults(resultRevenue.begin(), resultRevenue.end());
+    // Sort descending by revenue.
     std::sort(sortedResults.begin(), sortedResults.end(), [](const auto &a, const auto &b) {
         return a.second > b.second;
     });
@@ -188,11 +271,12 @@ void executeQuery(DataManager &dm, const CLIOptions &opts) {
     }
     outFile << "Nation,Revenue\n";
     for (const auto &entry : sortedResults) {
-        outFile << entry.first << "," << std::to_string(entry.second) << "\n";
+        outFile << entry.first << "," << entry.second.format(6) << "\n";
     }
     outFile.close();
     
-    std::cout << "Query executed successfully. Results written to " << opts.resultPath << "\n";
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryStart).count();
+    std::cout << "Query executed successfully in " << elapsedMs << " ms. Results written to " << opts.resultPath << "\n";
 }
 
 
@@ -208,8 +292,11 @@ int main(int argc, char *argv[]) {
     DataManager dm(options.customerPath, options.ordersPath, options.lineitemPath,
                    options.supplierPath, options.nationPath, options.regionPath,options.threads);
     
-    // Perform data loading in a separate thread.
-    dm.loadAllTables();
+    // Load only the columns Q5 reads. A streaming query reads lineitem itself.
+    options.load.columns = q5Columns();
+    if (options.streaming)
+        options.load.columns.lineitem = 0;
+    dm.loadAllTables(options.load);
 
     // Immediately queue a query—even though data might not be loaded yet.
     dm.processQuery([&dm, &options]() {
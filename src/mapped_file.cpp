@@ -0,0 +1,72 @@
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : fd(std::exchange(other.fd, -1)),
+      base(std::exchange(other.base, nullptr)),
+      length(std::exchange(other.length, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &filePath, Access access) {
+    close();
+    int newFd = ::open(filePath.c_str(), O_RDONLY);
+    if (newFd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(newFd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(newFd);
+        return false;
+    }
+
+    // mmap rejects zero-length mappings; an empty file is simply an empty range.
+    if (st.st_size > 0) {
+        void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, newFd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(newFd);
+            return false;
+        }
+        int advice = access == Access::Sequential ? MADV_SEQUENTIAL : MADV_NORMAL;
+        madvise(addr, static_cast<size_t>(st.st_size), advice);
+        base = static_cast<const char *>(addr);
+        length = static_cast<size_t>(st.st_size);
+    }
+    fd = newFd;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base != nullptr)
+        munmap(const_cast<char *>(base), length);
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    base = nullptr;
+    length = 0;
+}
+
+void MappedFile::release(const char *first, const char *last) const {
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t from = (reinterpret_cast<uintptr_t>(first) + page - 1) & ~(page - 1);
+    uintptr_t to = reinterpret_cast<uintptr_t>(last) & ~(page - 1);
+    if (from < to)
+        madvise(reinterpret_cast<void *>(from), to - from, MADV_DONTNEED);
+}
@@ -0,0 +1,69 @@
+#include "q5_pipeline.hpp"
+#include <algorithm>
+
+Q5Pipeline::Q5Pipeline(const Q5Plan &plan, Revenue::Slot *groups, bool prefetch)
+    : plan(plan), groups(groups), prefetch(prefetch) {}
+
+void Q5Pipeline::consume(const LineitemBatch &batch) {
+    // Filter: runtime join filters drop rows whose order or supplier cannot qualify.
+    size_t n = plan.orderFilter.probeBatch(batch.orderkey, nullptr, batch.rows, sel);
+    n = plan.supplierFilter.probeBatch(batch.suppkey, sel, n, sel);
+
+    // Probe: l_orderkey = o_orderkey against the qualifying orders (-> customer nation row).
+    size_t m = 0;
+    if (prefetch) {
+        for (size_t k = 0; k < std::min(n, PrefetchGroup); k++)
+            plan.orderNation.prefetch(batch.orderkey[sel[k]]);
+    }
+    for (size_t group = 0; group < n; group += PrefetchGroup) {
+        size_t groupEnd = std::min(n, group + PrefetchGroup);
+        if (prefetch) {
+            for (size_t k = groupEnd; k < std::min(n, groupEnd + PrefetchGroup); k++)
+                plan.orderNation.prefetch(batch.orderkey[sel[k]]);
+        }
+        for (size_t k = group; k < groupEnd; k++) {
+            uint32_t pos = sel[k];
+            uint8_t orderNation = plan.orderNation.find(batch.orderkey[pos]);
+            sel[m] = pos;
+            nation[m] = orderNation;
+            m += orderNation != KeyMap<uint8_t>::NotFound;
+        }
+    }
+    n = m;
+
+    // Probe + filter: l_suppkey = s_suppkey and c_nationkey = s_nationkey.
+    m = 0;
+    if (prefetch) {
+        for (size_t k = 0; k < std::min(n, PrefetchGroup); k++)
+            plan.supplierNation.prefetch(batch.suppkey[sel[k]]);
+    }
+    for (size_t group = 0; group < n; group += PrefetchGroup) {
+        size_t groupEnd = std::min(n, group + PrefetchGroup);
+        if (prefetch) {
+            for (size_t k = groupEnd; k < std::min(n, groupEnd + PrefetchGroup); k++)
+                plan.supplierNation.prefetch(batch.suppkey[sel[k]]);
+        }
+        for (size_t k = group; k < groupEnd; k++) {
+            uint32_t pos = sel[k];
+            uint8_t orderNation = nation[k];
+            sel[m] = pos;
+            nation[m] = orderNation;
+            m += plan.supplierNation.find(batch.suppkey[pos]) == orderNation;
+        }
+    }
+    n = m;
+
+    // Revenue: gather the surviving rows, then one vectorizable pass.
+    for (size_t k = 0; k < n; k++) {
+        price[k] = (*batch.extendedprice)[batch.first + sel[k]];
+        discount[k] = (*batch.discount)[batch.first + sel[k]];
+    }
+    for (size_t k = 0; k < n; k++)
+        amount[k] = discountedPrice(price[k], discount[k]);
+
+    // Aggregate: group revenue by nation.
+    for (size_t k = 0; k < n; k++) {
+        groups[nation[k]].sum += amount[k];
+        groups[nation[k]].rows++;
+    }
+}
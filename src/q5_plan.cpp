@@ -0,0 +1,124 @@
+#include "q5_plan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iostream>
+
+namespace {
+
+// Orders rows handed to one filter task: a whole number of zone map blocks.
+constexpr size_t OrdersPerTask = 1u << 18;
+static_assert(OrdersPerTask % ZoneMap::BlockRows == 0, "filter tasks cover whole zone map blocks");
+// Orders rows read per column batch within a task.
+constexpr size_t OrdersPerBatch = 1024;
+
+} // namespace
+
+ColumnSelection q5Columns() {
+    ColumnSelection columns;
+    columns.customer = columnBit(CustomerTable::CustkeyColumn) | columnBit(CustomerTable::NationkeyColumn);
+    columns.orders = columnBit(OrdersTable::OrderkeyColumn) | columnBit(OrdersTable::CustkeyColumn) |
+                     columnBit(OrdersTable::OrderdateColumn);
+    columns.lineitem = columnBit(LineitemTable::OrderkeyColumn) | columnBit(LineitemTable::SuppkeyColumn) |
+                       columnBit(LineitemTable::ExtendedpriceColumn) | columnBit(LineitemTable::DiscountColumn);
+    columns.supplier = columnBit(SupplierTable::SuppkeyColumn) | columnBit(SupplierTable::NationkeyColumn);
+    return columns;
+}
+
+Q5Plan planQ5(DataManager &dm, const std::string &region, int32_t startDay, int32_t endDay) {
+    Q5Plan plan;
+
+    // r_name = region, then n_regionkey = r_regionkey. Nation rows are stored as uint8_t.
+    std::vector<bool> nationInRegion(dm.nations.size(), false);
+    for (size_t n = 0; n < dm.nations.size() && n < KeyMap<uint8_t>::NotFound; n++) {
+        uint32_t r = dm.indexes.regions.find(dm.nations[n].regionkey);
+        nationInRegion[n] = r != JoinIndex::NotFound && dm.regions[r].name == region;
+    }
+    auto nationRow = [&](int nationkey) -> uint8_t {
+        uint32_t n = dm.indexes.nations.find(nationkey);
+        return n != JoinIndex::NotFound && nationInRegion[n] ? static_cast<uint8_t>(n) : KeyMap<uint8_t>::NotFound;
+    };
+
+    // Suppliers whose nation is in the region.
+    std::vector<int> suppKeys;
+    std::vector<uint8_t> suppNations;
+    for (size_t i = 0; i < dm.suppliers.size(); i++) {
+        uint8_t n = nationRow(dm.suppliers.nationkey[i]);
+        if (n == KeyMap<uint8_t>::NotFound)
+            continue;
+        suppKeys.push_back(dm.suppliers.suppkey[i]);
+        suppNations.push_back(n);
+    }
+    plan.qualifyingSuppliers = suppKeys.size();
+    plan.supplierFilter.build(suppKeys.data(), suppKeys.size());
+    plan.supplierNation.build(suppKeys.size(), [&](size_t i) { return suppKeys[i]; },
+                              [&](size_t i) { return suppNations[i]; },
+                              KeyMap<uint8_t>::MaxSlotsPerKey * std::max<size_t>(1, dm.suppliers.size()));
+
+    // Orders in the date range whose customer's nation is in the region, filtered in parallel.
+    // Orders blocks whose o_orderdate zone misses the range are skipped unread.
+    using Matches = std::pair<std::vector<int>, std::vector<uint8_t>>;
+    std::vector<std::future<Matches>> futures;
+    std::atomic<size_t> skippedBlocks{0};
+    for (size_t start = 0; start < dm.orders.size(); start += OrdersPerTask) {
+        size_t end = std::min(dm.orders.size(), start + OrdersPerTask);
+        futures.push_back(dm.pool.enqueue([&dm, &nationRow, &skippedBlocks, start, end, startDay, endDay]() {
+            // Rows are read a batch at a time so encoded columns are unpacked in blocks.
+            Matches matches;
+            int32_t dateBatch[OrdersPerBatch];
+            int custkeyBatch[OrdersPerBatch], orderkeyBatch[OrdersPerBatch];
+            for (size_t block = start; block < end; block += ZoneMap::BlockRows) {
+                size_t blockEnd = std::min(end, block + ZoneMap::BlockRows);
+                if (!dm.zoneMaps.ordersOrderdate.mayContain(block, blockEnd, startDay, int64_t(endDay) - 1)) {
+                    skippedBlocks++;
+                    continue;
+                }
+                for (size_t base = block; base < blockEnd; base += OrdersPerBatch) {
+                    size_t len = std::min(OrdersPerBatch, blockEnd - base);
+                    const int32_t *orderdates = dm.orders.orderdate.read(base, len, dateBatch);
+                    const int *custkeys = dm.orders.custkey.read(base, len, custkeyBatch);
+                    const int *orderkeys = dm.orders.orderkey.read(base, len, orderkeyBatch);
+                    for (size_t i = 0; i < len; i++) {
+                        if (orderdates[i] < startDay || orderdates[i] >= endDay)
+                            continue;
+                        uint32_t c = dm.indexes.customers.find(custkeys[i]);
+                        if (c == JoinIndex::NotFound)
+                            continue;
+                        uint8_t n = nationRow(dm.customers.nationkey[c]);
+                        if (n == KeyMap<uint8_t>::NotFound)
+                            continue;
+                        matches.first.push_back(orderkeys[i]);
+                        matches.second.push_back(n);
+                    }
+                }
+            }
+            return matches;
+        }));
+    }
+    for (auto &future : futures) {
+        Matches matches = future.get();
+        plan.orderKeys.insert(plan.orderKeys.end(), matches.first.begin(), matches.first.end());
+        plan.orderNations.insert(plan.orderNations.end(), matches.second.begin(), matches.second.end());
+    }
+    // Allow the reduced map as many slots as the full orders index would get, so it stays a
+    // direct-addressed byte array even though only a few percent of the keys remain.
+    plan.orderNation.build(plan.orderKeys.size(), [&](size_t i) { return plan.orderKeys[i]; },
+                           [&](size_t i) { return plan.orderNations[i]; },
+                           KeyMap<uint8_t>::MaxSlotsPerKey * std::max<size_t>(1, dm.orders.size()), &dm.pool);
+    plan.orderFilter.build(plan.orderKeys.data(), plan.orderKeys.size());
+    for (int key : plan.orderKeys) {
+        plan.minOrderKey = std::min(plan.minOrderKey, key);
+        plan.maxOrderKey = std::max(plan.maxOrderKey, key);
+    }
+    for (int key : suppKeys) {
+        plan.minSuppKey = std::min(plan.minSuppKey, key);
+        plan.maxSuppKey = std::max(plan.maxSuppKey, key);
+    }
+    plan.skippedOrdersBlocks = skippedBlocks;
+
+    std::cout << "Semi-join reduction: " << plan.orderKeys.size() << " of " << dm.orders.size()
+              << " orders and " << plan.qualifyingSuppliers << " of " << dm.suppliers.size()
+              << " suppliers qualify; zone maps skipped " << plan.skippedOrdersBlocks << " of "
+              << dm.zoneMaps.ordersOrderdate.blockCount() << " orders blocks.\n";
+    return plan;
+}
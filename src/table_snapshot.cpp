@@ -0,0 +1,232 @@
+#include "table_snapshot.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr uint64_t ColumnAlignment = 64;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + ColumnAlignment - 1) / ColumnAlignment * ColumnAlignment;
+}
+
+uint64_t mix(uint64_t h, uint64_t word) {
+    h ^= word;
+    h *= 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+// Bytes a column occupies in the file.
+uint64_t columnBytes(uint64_t rows, uint32_t elementSize, ColumnEncoding encoding, unsigned bits) {
+    if (encoding == ColumnEncoding::Plain)
+        return rows * elementSize;
+    return packedWordCount(rows, bits) * sizeof(uint32_t);
+}
+
+} // namespace
+
+uint64_t snapshotChecksum(const void *data, size_t bytes) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    uint64_t lanes[4] = {0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull, 0x082EFA98EC4E6C89ull};
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            std::memcpy(&word, p + i + 8 * lane, sizeof(word));
+            lanes[lane] = mix(lanes[lane], word);
+        }
+    }
+    uint64_t h = mix(mix(mix(mix(bytes, lanes[0]), lanes[1]), lanes[2]), lanes[3]);
+    for (; i < bytes; i++)
+        h = mix(h, p[i]);
+    return h;
+}
+
+void SnapshotWriter::add(const std::string &name, const void *data, uint64_t rows, uint32_t elementSize) {
+    columns.push_back(Pending{name, data, rows, elementSize, ColumnEncoding::Plain, 0, 0});
+}
+
+void SnapshotWriter::addEncoded(const std::string &name, const uint32_t *packed, uint64_t rows, uint32_t elementSize,
+                                ColumnEncoding encoding, unsigned bits, int64_t reference) {
+    columns.push_back(Pending{name, packed, rows, elementSize, encoding, bits, reference});
+}
+
+bool SnapshotWriter::write(const std::string &path, uint64_t fingerprint, std::string &error) const {
+    std::vector<SnapshotColumn> directory(columns.size());
+    uint64_t offset = alignUp(sizeof(SnapshotHeader) + directory.size() * sizeof(SnapshotColumn));
+    for (size_t i = 0; i < columns.size(); i++) {
+        const Pending &column = columns[i];
+        if (column.name.size() >= sizeof(directory[i].name)) {
+            error = "column name too long: " + column.name;
+            return false;
+        }
+        SnapshotColumn &entry = directory[i];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, column.name.data(), column.name.size());
+        entry.elementSize = column.elementSize;
+        entry.encoding = static_cast<uint8_t>(column.encoding);
+        entry.bits = static_cast<uint8_t>(column.bits);
+        entry.rows = column.rows;
+        entry.reference = column.reference;
+        entry.offset = offset;
+        entry.bytes = columnBytes(column.rows, column.elementSize, column.encoding, column.bits);
+        entry.checksum = snapshotChecksum(column.data, entry.bytes);
+        offset = alignUp(offset + entry.bytes);
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+    header.version = SnapshotVersion;
+    header.columnCount = static_cast<uint32_t>(directory.size());
+    header.fingerprint = fingerprint;
+    header.directoryChecksum = snapshotChecksum(directory.data(), directory.size() * sizeof(SnapshotColumn));
+
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot create " + tmpPath;
+        return false;
+    }
+    static const char padding[ColumnAlignment] = {};
+    uint64_t written = 0;
+    auto put = [&](const void *data, uint64_t bytes) {
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    };
+    auto padTo = [&](uint64_t target) { put(padding, target - written); };
+    put(&header, sizeof(header));
+    put(directory.data(), directory.size() * sizeof(SnapshotColumn));
+    for (size_t i = 0; i < columns.size(); i++) {
+        padTo(directory[i].offset);
+        put(columns[i].data, directory[i].bytes);
+    }
+    out.close();
+    if (!out) {
+        error = "cannot write " + tmpPath;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + tmpPath + " to " + path;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotReader::open(const std::string &path, uint64_t fingerprint, std::string &error) {
+    file.reset();
+    directory.clear();
+    auto mapped = std::make_shared<MappedFile>();
+    // Columns are scanned, but also probed at random (index builds, dictionary lookups), so
+    // keep the kernel's default readahead rather than the sequential hint.
+    if (!mapped->open(path, MappedFile::Access::Normal)) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (mapped->size() < sizeof(header)) {
+        error = "truncated header";
+        return false;
+    }
+    std::memcpy(&header, mapped->data(), sizeof(header));
+    if (std::memcmp(header.magic, SnapshotMagic, sizeof(header.magic)) != 0) {
+        error = "not a snapshot file";
+        return false;
+    }
+    if (header.version != SnapshotVersion) {
+        error = "format version " + std::to_string(header.version) + ", expected " + std::to_string(SnapshotVersion);
+        return false;
+    }
+    if (header.fingerprint != fingerprint) {
+        error = "written from other source files or load options";
+        return false;
+    }
+    uint64_t directoryBytes = uint64_t(header.columnCount) * sizeof(SnapshotColumn);
+    if (mapped->size() < sizeof(header) + directoryBytes) {
+        error = "truncated column directory";
+        return false;
+    }
+    const char *directoryStart = mapped->data() + sizeof(header);
+    if (snapshotChecksum(directoryStart, directoryBytes) != header.directoryChecksum) {
+        error = "column directory checksum mismatch";
+        return false;
+    }
+
+    // The header is 32 bytes and each entry 96, so entries are 8-byte aligned in the mapping.
+    const SnapshotColumn *entries = reinterpret_cast<const SnapshotColumn *>(directoryStart);
+    for (uint32_t i = 0; i < header.columnCount; i++) {
+        const SnapshotColumn &entry = entries[i];
+        std::string name(entry.name, strnlen(entry.name, sizeof(entry.name)));
+        ColumnEncoding encoding = static_cast<ColumnEncoding>(entry.encoding);
+        if (entry.encoding > static_cast<uint8_t>(ColumnEncoding::Dictionary) || entry.bits > 32) {
+            error = "column " + name + " has an unknown encoding";
+            return false;
+        }
+        if (entry.offset % ColumnAlignment != 0 || entry.bytes != columnBytes(entry.rows, entry.elementSize, encoding, entry.bits) ||
+            entry.offset > mapped->size() || entry.bytes > mapped->size() - entry.offset) {
+            error = "column " + name + " lies outside the file";
+            return false;
+        }
+        directory.push_back(&entry);
+    }
+    file = std::move(mapped);
+    return true;
+}
+
+bool SnapshotReader::verify(std::string &error, ThreadPool *pool) const {
+    std::vector<char> matches(directory.size(), 0);
+    auto check = [&](size_t i) {
+        const SnapshotColumn *entry = directory[i];
+        matches[i] = snapshotChecksum(file->data() + entry->offset, entry->bytes) == entry->checksum;
+    };
+    if (pool != nullptr) {
+        pool->parallelFor(directory.size(), check);
+    } else {
+        for (size_t i = 0; i < directory.size(); i++)
+            check(i);
+    }
+    for (size_t i = 0; i < directory.size(); i++) {
+        if (!matches[i]) {
+            const SnapshotColumn *entry = directory[i];
+            error = "column " + std::string(entry->name, strnlen(entry->name, sizeof(entry->name))) +
+                    " checksum mismatch";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SnapshotReader::codesBelow(const SnapshotColumn &entry, size_t limit) const {
+    // Every code of a full-width dictionary is in range; only the others need a pass.
+    if (entry.bits < 32 && limit >= (uint64_t(1) << entry.bits))
+        return true;
+    const uint32_t *packed = reinterpret_cast<const uint32_t *>(file->data() + entry.offset);
+    UnpackKernel unpack = unpackKernel();
+    constexpr size_t StepBlocks = 16;
+    uint32_t codes[StepBlocks * PackBlockValues];
+    size_t blocks = (entry.rows + PackBlockValues - 1) / PackBlockValues;
+    for (size_t block = 0; block < blocks; block += StepBlocks) {
+        size_t n = std::min(StepBlocks, blocks - block);
+        unpack(packed + block * packedBlockWords(entry.bits), entry.bits, n, codes);
+        // Padding past the last row is packed as zero, so it never fails the check.
+        for (size_t i = 0; i < n * PackBlockValues; i++) {
+            if (codes[i] >= limit)
+                return false;
+        }
+    }
+    return true;
+}
+
+const SnapshotColumn *SnapshotReader::find(const std::string &name) const {
+    for (const SnapshotColumn *entry : directory) {
+        if (strnlen(entry->name, sizeof(entry->name)) == name.size() && name.compare(0, name.size(), entry->name, name.size()) == 0)
+            return entry;
+    }
+    return nullptr;
+}
@@ -0,0 +1,119 @@
+// Packs random values at every width from 0 to 32 and checks that the scalar and AVX2 unpack
+// kernels and unpackValue all return them. Then encodes frame-of-reference, constant and
+// dictionary columns and compares read() and range() with the source values at offsets that
+// are not block aligned, across the ReadBlocks step and into the partial last block.
+
+#include "check.hpp"
+#include "columnar_table.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t Blocks = 3;
+constexpr size_t Rows = 3000; // ends in a partial block and spans several ReadBlocks steps
+
+// (first, count) windows: aligned and unaligned starts, single rows, block and ReadBlocks
+// boundaries, and windows reaching the last row.
+const std::pair<size_t, size_t> Windows[] = {
+    {0, Rows}, {0, 1}, {3, 250}, {255, 2}, {256, 256}, {250, 1100}, {1023, 2},
+    {700, 1500}, {2815, 185}, {2999, 1}, {1, Rows - 1}, {2900, 100},
+};
+
+void checkKernels() {
+    std::mt19937 random(42);
+    UnpackKernel avx2 = avx2UnpackKernel();
+    if (!avx2)
+        std::printf("bit_packing_check: no AVX2, checking the scalar kernel only\n");
+    for (unsigned bits = 0; bits <= 32; bits++) {
+        uint64_t mask = (uint64_t(1) << bits) - 1;
+        std::vector<uint32_t> values(Blocks * PackBlockValues);
+        for (uint32_t &value : values)
+            value = static_cast<uint32_t>(random() & mask);
+        if (bits > 0)
+            values[1] = static_cast<uint32_t>(mask); // the widest value of this width
+        std::vector<uint32_t> packed(packedWordCount(values.size(), bits));
+        for (size_t b = 0; b < Blocks; b++)
+            packBlock(values.data() + b * PackBlockValues, bits, packed.data() + b * packedBlockWords(bits));
+
+        std::vector<uint32_t> out(values.size(), 0xdeadbeef);
+        scalarUnpackKernel()(packed.data(), bits, Blocks, out.data());
+        CHECK(out == values);
+        if (avx2) {
+            std::fill(out.begin(), out.end(), 0xdeadbeef);
+            avx2(packed.data(), bits, Blocks, out.data());
+            CHECK(out == values);
+        }
+        bool same = true;
+        for (size_t i = 0; i < values.size(); i++)
+            same = same && unpackValue(packed.data(), bits, i) == values[i];
+        CHECK(same);
+    }
+}
+
+template <typename T>
+void checkColumn(const std::vector<T> &values, ColumnEncoding expected) {
+    Column<T> column;
+    for (const T &value : values)
+        column.push_back(value);
+    column.encode();
+    CHECK(column.encoding() == expected);
+    CHECK(column.size() == values.size());
+
+    bool same = true;
+    for (size_t i = 0; i < values.size(); i++)
+        same = same && column[i] == values[i];
+    CHECK(same);
+
+    std::vector<T> scratch(values.size());
+    for (const auto &[first, count] : Windows) {
+        const T *rows = column.read(first, count, scratch.data());
+        CHECK(std::equal(rows, rows + count, values.begin() + first));
+        auto [lo, hi] = std::minmax_element(values.begin() + first, values.begin() + first + count);
+        auto range = column.range(first, count);
+        CHECK(range.first == *lo);
+        CHECK(range.second == *hi);
+    }
+}
+
+} // namespace
+
+int main() {
+    checkKernels();
+
+    // 1000 distinct values in a range of 1000: too many for a dictionary, 10-bit frame of reference.
+    std::vector<int> forValues;
+    for (size_t i = 0; i < Rows; i++)
+        forValues.push_back(static_cast<int>(5000 + i * 37 % 1000));
+    checkColumn(forValues, ColumnEncoding::FrameOfReference);
+
+    // A constant column: frame of reference at width 0, with no packed words at all.
+    checkColumn(std::vector<int>(Rows, -17), ColumnEncoding::FrameOfReference);
+
+    // Ten values spread over two million, first seen out of order, in short runs so that small
+    // windows hold only a few of them: a 4-bit dictionary, sorted so codes keep the value order.
+    const int spread[] = {900000, -200000, 42, 7, -7, 300000, 1, -1000000, 55555, 2};
+    std::vector<int> dictValues;
+    for (size_t i = 0; i < Rows; i++)
+        dictValues.push_back(spread[(i / 97 + i % 3) % 10]);
+    checkColumn(dictValues, ColumnEncoding::Dictionary);
+
+    Column<int> dictColumn;
+    for (int value : dictValues)
+        dictColumn.push_back(value);
+    dictColumn.encode();
+    CHECK(dictColumn.dictionarySize() == 10);
+    CHECK(dictColumn.packedBits() == 4);
+    CHECK(std::is_sorted(dictColumn.dictionary(), dictColumn.dictionary() + dictColumn.dictionarySize()));
+
+    // Decimal columns encode through the same codec.
+    std::vector<Money> prices;
+    for (size_t i = 0; i < Rows; i++)
+        prices.push_back(Money{static_cast<int64_t>(90000 + i * 7919 % 20000)});
+    checkColumn(prices, ColumnEncoding::FrameOfReference);
+
+    return check::result();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <iostream>
+
+// Minimal assertions for the self-checking programs in tests/: CHECK reports a failed
+// condition with its location and the program exits non-zero at the end (checkResult).
+
+namespace check {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void record(bool ok, const char *condition, const char *file, int line) {
+    if (ok)
+        return;
+    std::cerr << file << ":" << line << ": CHECK failed: " << condition << "\n";
+    failures()++;
+}
+
+// The exit status of main: 0 if every check passed.
+inline int result() {
+    if (failures() != 0)
+        std::cerr << failures() << " check(s) failed\n";
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace check
+
+#define CHECK(condition) ::check::record(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,30 @@
+// Checks Decimal's exact formatting, in particular that values are rounded once, half away
+// from zero, when fewer digits than the scale are printed.
+
+#include "check.hpp"
+#include "decimal.hpp"
+
+int main() {
+    // Exact and zero padded.
+    CHECK(Decimal<4>{1234567}.format(4) == "123.4567");
+    CHECK(Decimal<4>{1234567}.format(6) == "123.456700");
+    CHECK(Decimal<2>{5}.format(2) == "0.05");
+    CHECK(Decimal<2>{-5}.format(3) == "-0.050");
+
+    // Rounded once: 0.0149 is 0.01 and 0.0045 is 0.00, not 0.02 and 0.01.
+    CHECK(Decimal<4>{149}.format(2) == "0.01");
+    CHECK(Decimal<4>{45}.format(2) == "0.00");
+    CHECK(Decimal<4>{-149}.format(2) == "-0.01");
+
+    // Half away from zero.
+    CHECK(Decimal<4>{150}.format(2) == "0.02");
+    CHECK(Decimal<4>{-150}.format(2) == "-0.02");
+    CHECK(Decimal<4>{5000}.format(0) == "1");
+    CHECK(Decimal<4>{4999}.format(0) == "0");
+    CHECK(Decimal<4>{-4999}.format(0) == "0");
+    CHECK(Decimal<4>{99995}.format(3) == "10.000");
+
+    // Arithmetic stays exact.
+    CHECK(discountedPrice(Money{3690160}, Money{4}).format(4) == "35425.5360");
+    return check::result();
+}
@@ -0,0 +1,143 @@
+// Checks the allocation-free submission paths of ThreadPool: PoolTask's inline and heap
+// storage (every callable is destroyed exactly once, through emplace, reset and the
+// destructor), submit() of caller-owned tasks from outside and from inside the pool with a
+// WaitGroup, and parallelFor, including an exception thrown by one iteration.
+// Run it under -fsanitize=address or -fsanitize=thread to cover the memory and race side.
+
+#include "check.hpp"
+#include "thread_pool.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Counts live instances, so a leaked or doubly destroyed callable shows up as a nonzero balance.
+std::atomic<int> liveCallables{0};
+
+template <size_t Padding>
+struct Tracked {
+    std::atomic<int> *runs;
+    std::array<char, Padding> padding{};
+
+    explicit Tracked(std::atomic<int> *runs) : runs(runs) { liveCallables++; }
+    Tracked(const Tracked &other) : runs(other.runs), padding(other.padding) { liveCallables++; }
+    Tracked(Tracked &&other) noexcept : runs(other.runs), padding(other.padding) { liveCallables++; }
+    ~Tracked() { liveCallables--; }
+    void operator()() { (*runs)++; }
+};
+
+using SmallCallable = Tracked<8>;    // stored inside the PoolTask
+using LargeCallable = Tracked<128>;  // larger than InlineBytes: stored on the heap
+
+void taskStorage() {
+    static_assert(sizeof(SmallCallable) <= PoolTask::InlineBytes, "stored inline");
+    static_assert(sizeof(LargeCallable) > PoolTask::InlineBytes, "stored on the heap");
+    std::atomic<int> runs{0};
+    {
+        PoolTask task;
+        task.emplace(SmallCallable(&runs));
+        CHECK(liveCallables.load() == 1);
+        task();
+        task.emplace(LargeCallable(&runs)); // replaces the inline callable
+        CHECK(liveCallables.load() == 1);
+        task();
+        task.reset();
+        CHECK(liveCallables.load() == 0);
+        task.reset(); // resetting an empty task is a no-op
+        LargeCallable large(&runs);
+        task.emplace(large); // copied in
+        CHECK(liveCallables.load() == 2);
+        task.emplace(SmallCallable(&runs)); // replaces the heap callable
+        task();
+    } // the destructor destroys the last callable
+    CHECK(runs.load() == 3);
+    CHECK(liveCallables.load() == 0);
+}
+
+void submitAndWait(ThreadPool &pool) {
+    constexpr size_t Outer = 64;
+    constexpr size_t Inner = 16;
+    std::atomic<int> runs{0};
+    WaitGroup group;
+    // Each outer task submits its own inner tasks from the worker, so they go to its deque.
+    std::vector<std::unique_ptr<PoolTask[]>> inner(Outer);
+    for (auto &tasks : inner)
+        tasks.reset(new PoolTask[Inner]);
+    std::unique_ptr<PoolTask[]> outer(new PoolTask[Outer]);
+    group.add(Outer * (1 + Inner));
+    for (size_t o = 0; o < Outer; o++) {
+        outer[o].emplace([&, o]() {
+            for (size_t i = 0; i < Inner; i++) {
+                if (i % 2 == 0) {
+                    inner[o][i].emplace([&group, tracked = SmallCallable(&runs)]() mutable {
+                        tracked();
+                        group.done();
+                    });
+                } else {
+                    inner[o][i].emplace([&group, tracked = LargeCallable(&runs)]() mutable {
+                        tracked();
+                        group.done();
+                    });
+                }
+            }
+            pool.submit(inner[o].get(), Inner);
+            runs++;
+            group.done();
+        });
+    }
+    pool.submit(outer.get(), Outer);
+    group.wait();
+    CHECK(runs.load() == static_cast<int>(Outer * (1 + Inner)));
+    outer.reset();
+    inner.clear();
+    CHECK(liveCallables.load() == 0);
+}
+
+void parallelForCoverage(ThreadPool &pool) {
+    for (size_t count : {size_t(0), size_t(1), size_t(3), size_t(10000)}) {
+        std::vector<std::atomic<int>> visits(count);
+        pool.parallelFor(count, [&](size_t i) { visits[i]++; });
+        bool once = true;
+        for (auto &v : visits)
+            once = once && v.load() == 1;
+        CHECK(once);
+    }
+}
+
+void parallelForException(ThreadPool &pool) {
+    constexpr size_t Count = 10000;
+    std::atomic<size_t> ran{0};
+    bool thrown = false;
+    try {
+        pool.parallelFor(Count, [&](size_t i) {
+            if (i == 1234)
+                throw std::runtime_error("iteration failed");
+            ran++;
+        });
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    // The other tasks stop claiming indices after the failure.
+    CHECK(ran.load() < Count);
+    // The pool is still usable afterwards.
+    std::atomic<size_t> after{0};
+    pool.parallelFor(100, [&](size_t) { after++; });
+    CHECK(after.load() == 100);
+}
+
+} // namespace
+
+int main() {
+    taskStorage();
+    for (size_t threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads);
+        submitAndWait(pool);
+        parallelForCoverage(pool);
+        parallelForException(pool);
+    }
+    return check::result();
+}
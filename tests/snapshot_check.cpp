@@ -0,0 +1,149 @@
+// Writes a small snapshot (a plain, a frame-of-reference and a dictionary column), reads it
+// back, and checks that damaged or mismatched files are rejected: truncated, another format
+// version, another fingerprint, a flipped column byte, and dictionary codes past the end of
+// the dictionary.
+
+#include "check.hpp"
+#include "table_snapshot.hpp"
+#include "thread_pool.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t Fingerprint = 0x5eed;
+constexpr size_t Rows = 1000; // not a multiple of PackBlockValues: the last block is partial
+
+std::string readFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &path, const std::string &bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool opens(const std::string &path, uint64_t fingerprint = Fingerprint) {
+    SnapshotReader reader;
+    std::string error;
+    return reader.open(path, fingerprint, error);
+}
+
+const SnapshotColumn *entryOf(const std::string &bytes, const char *name) {
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    const SnapshotColumn *entries = reinterpret_cast<const SnapshotColumn *>(bytes.data() + sizeof(header));
+    for (uint32_t i = 0; i < header.columnCount; i++) {
+        if (std::strcmp(entries[i].name, name) == 0)
+            return &entries[i];
+    }
+    return nullptr;
+}
+
+} // namespace
+
+int main() {
+    const std::string path = "snapshot_check.snap";
+    const std::string damaged = "snapshot_check_damaged.snap";
+
+    Column<int> plain, forColumn, dictColumn;
+    for (size_t i = 0; i < Rows; i++) {
+        plain.push_back(static_cast<int>(i * 7919));
+        forColumn.push_back(static_cast<int>(1000000 + i % 300));
+        dictColumn.push_back(static_cast<int>((i % 5) * 100000)); // 5 values, far apart
+    }
+    Column<int> forEncoded = forColumn, dictEncoded = dictColumn;
+    forEncoded.encode();
+    dictEncoded.encode();
+    CHECK(forEncoded.encoding() == ColumnEncoding::FrameOfReference);
+    CHECK(dictEncoded.encoding() == ColumnEncoding::Dictionary);
+
+    SnapshotWriter writer;
+    writer.add("t.plain", plain);
+    writer.add("t.for", forEncoded);
+    writer.add("t.dict", dictEncoded);
+    std::string error;
+    CHECK(writer.write(path, Fingerprint, error));
+
+    // Round trip.
+    {
+        ThreadPool pool(2);
+        SnapshotReader reader;
+        CHECK(reader.open(path, Fingerprint, error));
+        CHECK(reader.verify(error));
+        CHECK(reader.verify(error, &pool));
+        Column<int> a, b, c;
+        CHECK(reader.column("t.plain", a) && !a.isEncoded());
+        CHECK(reader.column("t.for", b) && b.encoding() == ColumnEncoding::FrameOfReference);
+        CHECK(reader.column("t.dict", c) && c.encoding() == ColumnEncoding::Dictionary);
+        bool same = a.size() == Rows && b.size() == Rows && c.size() == Rows;
+        for (size_t i = 0; same && i < Rows; i++)
+            same = a[i] == plain[i] && b[i] == forColumn[i] && c[i] == dictColumn[i];
+        CHECK(same);
+        Column<Money> wrongType;
+        CHECK(!reader.column("t.plain", wrongType));
+        CHECK(!reader.column("t.missing", a));
+    }
+
+    const std::string good = readFile(path);
+
+    // Truncated: the header, the directory, and the last column.
+    writeFile(damaged, good.substr(0, sizeof(SnapshotHeader) - 1));
+    CHECK(!opens(damaged));
+    writeFile(damaged, good.substr(0, sizeof(SnapshotHeader) + sizeof(SnapshotColumn)));
+    CHECK(!opens(damaged));
+    writeFile(damaged, good.substr(0, good.size() - 1));
+    CHECK(!opens(damaged));
+
+    // Another format version; another fingerprint.
+    {
+        std::string bytes = good;
+        uint32_t version = SnapshotVersion + 1;
+        std::memcpy(&bytes[offsetof(SnapshotHeader, version)], &version, sizeof(version));
+        writeFile(damaged, bytes);
+        CHECK(!opens(damaged));
+        CHECK(!opens(path, Fingerprint + 1));
+    }
+
+    // A flipped byte in a column opens (only the directory is checked) but fails verify.
+    {
+        std::string bytes = good;
+        bytes[entryOf(bytes, "t.plain")->offset + 17] ^= 0x01;
+        writeFile(damaged, bytes);
+        SnapshotReader reader;
+        CHECK(reader.open(damaged, Fingerprint, error));
+        CHECK(!reader.verify(error));
+        CHECK(error.find("t.plain") != std::string::npos);
+    }
+
+    // A flipped byte in the directory is caught by open.
+    {
+        std::string bytes = good;
+        bytes[sizeof(SnapshotHeader) + offsetof(SnapshotColumn, rows)] ^= 0x01;
+        writeFile(damaged, bytes);
+        CHECK(!opens(damaged));
+    }
+
+    // Dictionary codes past the end of the dictionary: 5 values use 3 bits, so setting every
+    // bit of the first block makes its codes 7. Without verify, column() must still refuse it.
+    {
+        std::string bytes = good;
+        const SnapshotColumn *entry = entryOf(bytes, "t.dict");
+        std::memset(&bytes[entry->offset], 0xFF, packedBlockWords(entry->bits) * sizeof(uint32_t));
+        writeFile(damaged, bytes);
+        SnapshotReader reader;
+        CHECK(reader.open(damaged, Fingerprint, error));
+        Column<int> column;
+        CHECK(!reader.column("t.dict", column));
+        CHECK(reader.column("t.for", column));
+    }
+
+    std::remove(path.c_str());
+    std::remove(damaged.c_str());
+    return check::result();
+}
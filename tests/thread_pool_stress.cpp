@@ -0,0 +1,92 @@
+// Stress test for the work-stealing ThreadPool: many pools of different sizes, bulk submission
+// from outside the pool, nested submission from workers (their Chase-Lev deques, drained by
+// thieves), a worker overflowing its deque into the injection queue, and exceptions carried by
+// futures. Every task must run exactly once.
+//
+// Usage: thread_pool_stress [rounds]
+// Most useful under ThreadSanitizer: configure with -DCMAKE_CXX_FLAGS=-fsanitize=thread.
+
+#include "check.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Pool tasks must not wait, so the test thread polls the counter the tasks bump.
+void waitFor(const std::atomic<size_t> &counter, size_t expected) {
+    while (counter.load() < expected)
+        std::this_thread::yield();
+}
+
+void outsideSubmission(ThreadPool &pool) {
+    constexpr size_t Tasks = 2000;
+    std::atomic<uint64_t> sum{0};
+    std::vector<std::future<size_t>> futures;
+    for (size_t i = 0; i < Tasks; i++)
+        futures.push_back(pool.enqueue([&sum, i]() { sum += i; return i; }));
+    uint64_t returned = 0;
+    for (auto &future : futures)
+        returned += future.get();
+    CHECK(sum.load() == Tasks * (Tasks - 1) / 2);
+    CHECK(returned == Tasks * (Tasks - 1) / 2);
+}
+
+void nestedSubmission(ThreadPool &pool) {
+    constexpr size_t Parents = 64;
+    constexpr size_t Children = 100;
+    std::atomic<size_t> ran{0};
+    std::vector<std::future<void>> parents;
+    for (size_t p = 0; p < Parents; p++) {
+        parents.push_back(pool.enqueue([&pool, &ran]() {
+            for (size_t c = 0; c < Children; c++)
+                pool.enqueue([&ran]() { ran++; });
+        }));
+    }
+    for (auto &parent : parents)
+        parent.get();
+    waitFor(ran, Parents * Children);
+    CHECK(ran.load() == Parents * Children);
+}
+
+// One worker pushes more tasks than its deque holds; the rest must go to the injection queue.
+void dequeOverflow(ThreadPool &pool) {
+    const size_t children = 4096 + 1000;
+    std::atomic<size_t> ran{0};
+    pool.enqueue([&pool, &ran, children]() {
+        for (size_t c = 0; c < children; c++)
+            pool.enqueue([&ran]() { ran++; });
+    }).get();
+    waitFor(ran, children);
+    CHECK(ran.load() == children);
+}
+
+void exceptions(ThreadPool &pool) {
+    auto failing = pool.enqueue([]() -> int { throw std::runtime_error("task failed"); });
+    bool thrown = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(pool.enqueue([]() { return 7; }).get() == 7);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20;
+    for (size_t round = 0; round < rounds; round++) {
+        ThreadPool pool(1 + round % 8);
+        outsideSubmission(pool);
+        nestedSubmission(pool);
+        dequeOverflow(pool);
+        exceptions(pool);
+    }
+    return check::result();
+}